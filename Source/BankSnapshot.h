@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Bank.h"
+#include "CurveTables.h"
+#include <array>
+#include <vector>
+
+// An immutable copy of all four banks as the audio thread sees them. Built on the
+// message thread by SpectrasaurusAudioProcessor::publishBanks and swapped in whole,
+// so the audio thread never reads a bank while it is being edited.
+//
+// Before it goes live the builder thread compiles the banks' curves into tables
+// for every engine layout in use, and works out which processing stages they use,
+// so no engine looks at a curve on the audio thread.
+struct BankSnapshot
+{
+    // Stages some bank moves away from identity; the engines skip the others
+    struct ActiveStages
+    {
+        bool delay = false;
+        bool pan = false;
+        bool feedback = false;
+        bool dynamics = false;
+        bool shift = false;
+    };
+
+    std::array<Bank, 4> banks;
+    std::vector<CurveTables> curveTables; // one per layout
+    ActiveStages activeStages {};
+
+    static ActiveStages findActiveStages(const std::array<Bank, 4>& banks)
+    {
+        ActiveStages active;
+        for (auto& bank : banks)
+        {
+            active.delay = active.delay || !bank.delayL.isFlat(0.0f) || !bank.delayR.isFlat(0.0f);
+            active.pan = active.pan || !bank.panL.isFlat(0.0f) || !bank.panR.isFlat(0.0f);
+            active.feedback = active.feedback || !bank.feedbackL.isFlat(0.0f) || !bank.feedbackR.isFlat(0.0f);
+            active.dynamics = active.dynamics
+                || !bank.preGainL.isFlat(1.0f) || !bank.preGainR.isFlat(1.0f)
+                || !bank.minGateL.isFlat(0.0f) || !bank.minGateR.isFlat(0.0f)
+                || !bank.maxClipL.isFlat(1.0f) || !bank.maxClipR.isFlat(1.0f);
+            active.shift = active.shift
+                || !bank.shiftL.isFlat(0.5f) || !bank.shiftR.isFlat(0.5f)
+                || !bank.multiplyL.isFlat(0.5f) || !bank.multiplyR.isFlat(0.5f);
+        }
+        return active;
+    }
+
+    const CurveTables* findCurveTables(const CurveTableLayout& layout) const
+    {
+        for (auto& tables : curveTables)
+            if (tables.layout == layout)
+                return &tables;
+        return nullptr;
+    }
+};
@@ -0,0 +1,358 @@
+#include "BinDelayArena.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define SPECTRASAURUS_HAS_F16C_PATH 1
+ #include <immintrin.h>
+ #if defined(__GNUC__) || defined(__clang__)
+  #define SPECTRASAURUS_F16C_TARGET __attribute__((target("avx,f16c")))
+ #else
+  #define SPECTRASAURUS_F16C_TARGET
+ #endif
+#else
+ #define SPECTRASAURUS_HAS_F16C_PATH 0
+#endif
+
+namespace
+{
+constexpr size_t kCacheLineBytes = 64;
+
+// Bins ahead of the current one whose read heads are prefetched (two tiles)
+constexpr int kPrefetchBins = 2 * BinDelayArena::kTileBins;
+
+// Largest finite half float
+constexpr float kMaxHalf = 65504.0f;
+
+inline void prefetchRead(const void* address)
+{
+   #if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 1);
+   #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T1);
+   #else
+    juce::ignoreUnused(address);
+   #endif
+}
+
+// Portable conversions, rounding exactly like the F16C instructions
+uint16_t toHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    bits &= 0x7fffffffu;
+
+    if (bits >= 0x47800000u) // 65520 and up (rounds to infinity), infinity or NaN
+        return sign | (bits > 0x7f800000u ? 0x7e00u : 0x7c00u);
+
+    if (bits < 0x38800000u) // below the smallest normal half
+    {
+        // Adding 0.5 leaves the half's subnormal mantissa in the low bits, rounded by the FPU
+        float shifted;
+        std::memcpy(&shifted, &bits, sizeof(shifted));
+        shifted += 0.5f;
+        std::memcpy(&bits, &shifted, sizeof(bits));
+        return sign | static_cast<uint16_t>(bits - 0x3f000000u);
+    }
+
+    // Rebias the exponent and round the mantissa to nearest even
+    const uint32_t mantissaOdd = (bits >> 13) & 1u;
+    bits += 0xc8000fffu + mantissaOdd;
+    return sign | static_cast<uint16_t>(bits >> 13);
+}
+
+float fromHalf(uint16_t half)
+{
+    uint32_t bits = static_cast<uint32_t>(half & 0x7fffu) << 13;
+    const uint32_t exponent = bits & 0x0f800000u;
+    bits += 0x38000000u; // rebias
+
+    float value;
+    if (exponent == 0x0f800000u) // infinity or NaN (quietened)
+    {
+        bits += 0x38000000u;
+        if ((bits & 0x007fffffu) != 0)
+            bits |= 0x00400000u;
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+    else if (exponent == 0) // zero or subnormal: renormalise through the FPU
+    {
+        bits += 0x00800000u;
+        std::memcpy(&value, &bits, sizeof(value));
+        value -= 6.103515625e-05f; // 2^-14
+    }
+    else
+    {
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+
+    return (half & 0x8000u) != 0 ? -value : value;
+}
+
+#if SPECTRASAURUS_HAS_F16C_PATH
+// Every CPU with AVX2 also has F16C (JUCE doesn't report F16C on its own)
+bool canUseF16C()
+{
+    static const bool supported = juce::SystemStats::hasAVX2();
+    return supported;
+}
+
+SPECTRASAURUS_F16C_TARGET int floatToHalfF16C(const float* src, uint16_t* dest, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    return i;
+}
+
+SPECTRASAURUS_F16C_TARGET int halfToFloatF16C(const uint16_t* src, float* dest, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    return i;
+}
+#endif
+} // namespace
+
+void BinDelayArena::floatToHalf(const float* src, uint16_t* dest, int n)
+{
+    int i = 0;
+   #if SPECTRASAURUS_HAS_F16C_PATH
+    if (canUseF16C())
+        i = floatToHalfF16C(src, dest, n);
+   #endif
+    for (; i < n; ++i)
+        dest[i] = toHalf(src[i]);
+}
+
+void BinDelayArena::halfToFloat(const uint16_t* src, float* dest, int n)
+{
+    int i = 0;
+   #if SPECTRASAURUS_HAS_F16C_PATH
+    if (canUseF16C())
+        i = halfToFloatF16C(src, dest, n);
+   #endif
+    for (; i < n; ++i)
+        dest[i] = fromHalf(src[i]);
+}
+
+void BinDelayArena::allocate(const std::vector<int>& maxDelayFrames, bool halfPrecision, float fullScale)
+{
+    sampleBytes = halfPrecision ? sizeof(uint16_t) : sizeof(float);
+
+    // A power of two, so scaling loses nothing
+    halfScale = fullScale > 0.0f ? 1.0f / std::exp2(std::ceil(std::log2(fullScale))) : 1.0f;
+
+    const int numBins = static_cast<int>(maxDelayFrames.size());
+    tiles.assign(static_cast<size_t>((numBins + kTileBins - 1) / kTileBins), {});
+
+    // A delay of d frames reads the sample written d frames ago, so needs d + 1 frames
+    size_t numBytes = 0;
+    for (int bin = 0; bin < numBins; bin += kTileBins)
+    {
+        int longest = 0;
+        for (int i = bin; i < std::min(numBins, bin + kTileBins); ++i)
+            longest = std::max(longest, maxDelayFrames[static_cast<size_t>(i)]);
+
+        auto& tile = tiles[static_cast<size_t>(bin / kTileBins)];
+        tile.offset = numBytes;
+        if (longest > 0)
+        {
+            const int ringFrames = juce::nextPowerOfTwo(longest + 1);
+            tile.mask = ringFrames - 1;
+            numBytes += static_cast<size_t>(ringFrames) * kTileBins * 2 * sampleBytes;
+        }
+    }
+
+    storage.assign(numBytes == 0 ? 0 : numBytes + kCacheLineBytes, 0);
+    auto misalignment = reinterpret_cast<std::uintptr_t>(storage.data()) % kCacheLineBytes;
+    frames = storage.data() + (misalignment == 0 ? 0 : kCacheLineBytes - misalignment);
+
+    writePos.assign(static_cast<size_t>(numBins), 0);
+    framesRecorded.assign(static_cast<size_t>(numBins), 0);
+    previous = nullptr;
+}
+
+void BinDelayArena::clear()
+{
+    std::fill(storage.begin(), storage.end(), uint8_t(0));
+    std::fill(writePos.begin(), writePos.end(), 0);
+    previous = nullptr;
+}
+
+int BinDelayArena::getLongestDelayFrames() const
+{
+    int longest = 0;
+    for (auto& tile : tiles)
+        longest = std::max(longest, tile.mask);
+    return longest;
+}
+
+void BinDelayArena::continueFrom(const BinDelayArena& previousArena)
+{
+    previous = &previousArena;
+    std::fill(framesRecorded.begin(), framesRecorded.end(), 0);
+}
+
+void BinDelayArena::readSample(int bin, int frame, float* sample) const
+{
+    // Rounds exactly like the tile-at-a-time paths
+    const uint8_t* slot = getSlot(bin, frame);
+    if (isHalfPrecision())
+    {
+        uint16_t halves[2];
+        std::memcpy(halves, slot, sizeof(halves));
+        const float inverseScale = 1.0f / halfScale;
+        sample[0] = fromHalf(halves[0]) * inverseScale;
+        sample[1] = fromHalf(halves[1]) * inverseScale;
+    }
+    else
+    {
+        std::memcpy(sample, slot, 2 * sizeof(float));
+    }
+}
+
+void BinDelayArena::writeSample(int bin, int frame, float re, float im)
+{
+    uint8_t* slot = getSlot(bin, frame);
+    if (isHalfPrecision())
+    {
+        const uint16_t halves[2] = { toHalf(std::clamp(re * halfScale, -kMaxHalf, kMaxHalf)),
+                                     toHalf(std::clamp(im * halfScale, -kMaxHalf, kMaxHalf)) };
+        std::memcpy(slot, halves, sizeof(halves));
+    }
+    else
+    {
+        const float sample[2] = { re, im };
+        std::memcpy(slot, sample, sizeof(sample));
+    }
+}
+
+void BinDelayArena::process(float* re, float* im, const int* delayFrames, int begin, int end)
+{
+    if (previous != nullptr)
+        processContinuing(re, im, delayFrames, begin, end);
+    else if (isHalfPrecision())
+        processHalf(re, im, delayFrames, begin, end);
+    else
+        processFloat(re, im, delayFrames, begin, end);
+}
+
+void BinDelayArena::processFloat(float* re, float* im, const int* delayFrames, int begin, int end)
+{
+    for (int bin = begin; bin < end; ++bin)
+    {
+        const int ahead = bin + kPrefetchBins;
+        if (ahead < end && delayFrames[ahead] > 0)
+            prefetchRead(getSlot(ahead, (writePos[static_cast<size_t>(ahead)] - delayFrames[ahead])
+                                            & getMaxDelayFrames(ahead)));
+
+        const int delay = delayFrames[bin];
+        if (delay <= 0)
+            continue;
+
+        const int mask = getMaxDelayFrames(bin);
+        int& wp = writePos[static_cast<size_t>(bin)];
+        auto* in = reinterpret_cast<float*>(getSlot(bin, wp));
+        in[0] = re[bin];
+        in[1] = im[bin];
+
+        const auto* out = reinterpret_cast<const float*>(getSlot(bin, (wp - delay) & mask));
+        re[bin] = out[0];
+        im[bin] = out[1];
+        wp = (wp + 1) & mask;
+    }
+}
+
+void BinDelayArena::processHalf(float* re, float* im, const int* delayFrames, int begin, int end)
+{
+    const float inverseScale = 1.0f / halfScale;
+
+    // A tile's worth of bins at a time, so each conversion covers 16 values; the
+    // rings themselves are read and written one complex (32-bit) sample per bin
+    float samples[kTileBins * 2];
+    uint16_t halves[kTileBins * 2];
+
+    for (int first = begin; first < end; first += kTileBins)
+    {
+        const int count = std::min(kTileBins, end - first);
+
+        for (int i = 0; i < count; ++i)
+        {
+            samples[2 * i]     = std::clamp(re[first + i] * halfScale, -kMaxHalf, kMaxHalf);
+            samples[2 * i + 1] = std::clamp(im[first + i] * halfScale, -kMaxHalf, kMaxHalf);
+        }
+        floatToHalf(samples, halves, count * 2);
+
+        for (int i = 0; i < count; ++i)
+        {
+            const int bin = first + i;
+            const int ahead = bin + kPrefetchBins;
+            if (ahead < end && delayFrames[ahead] > 0)
+                prefetchRead(getSlot(ahead, (writePos[static_cast<size_t>(ahead)] - delayFrames[ahead])
+                                                & getMaxDelayFrames(ahead)));
+
+            const int delay = delayFrames[bin];
+            if (delay <= 0)
+                continue;
+
+            // The ring slot takes this frame's value, and the halves array the delayed one
+            const int mask = getMaxDelayFrames(bin);
+            int& wp = writePos[static_cast<size_t>(bin)];
+            uint16_t delayed[2];
+            std::memcpy(delayed, getSlot(bin, (wp - delay) & mask), sizeof(delayed));
+            std::memcpy(getSlot(bin, wp), halves + 2 * i, sizeof(delayed));
+            std::memcpy(halves + 2 * i, delayed, sizeof(delayed));
+            wp = (wp + 1) & mask;
+        }
+
+        halfToFloat(halves, samples, count * 2);
+        for (int i = 0; i < count; ++i)
+        {
+            if (delayFrames[first + i] <= 0)
+                continue;
+            re[first + i] = samples[2 * i] * inverseScale;
+            im[first + i] = samples[2 * i + 1] * inverseScale;
+        }
+    }
+}
+
+void BinDelayArena::processContinuing(float* re, float* im, const int* delayFrames, int begin, int end)
+{
+    for (int bin = begin; bin < end; ++bin)
+    {
+        const int delay = delayFrames[bin];
+        if (delay <= 0)
+            continue;
+
+        // The last `recorded` frames are here; older ones are in previous's ring,
+        // which stopped the frame before the switch
+        const auto index = static_cast<size_t>(bin);
+        const int mask = getMaxDelayFrames(bin);
+        int& wp = writePos[index];
+        int& recorded = framesRecorded[index];
+
+        float delayed[2] = { 0.0f, 0.0f };
+        if (delay <= recorded)
+        {
+            readSample(bin, (wp - delay) & mask, delayed);
+        }
+        else
+        {
+            const int age = delay - recorded;
+            const int previousMask = previous->getMaxDelayFrames(bin);
+            if (previousMask > 0 && age <= previousMask + 1)
+                previous->readSample(bin, (previous->writePos[index] - age) & previousMask, delayed);
+        }
+
+        writeSample(bin, wp, re[bin], im[bin]);
+        re[bin] = delayed[0];
+        im[bin] = delayed[1];
+        wp = (wp + 1) & mask;
+        recorded = std::min(recorded + 1, mask + 1);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <vector>
+
+// Per-bin spectral delay lines for one channel, in a single aligned block.
+//
+// Bins are grouped in tiles of kTileBins. A tile stores its bins' complex samples
+// (interleaved real/imag) frame by frame, so one frame of a tile is exactly one
+// cache line, and neighbouring bins with the same delay read from the same line.
+// Each tile's ring is a power of two frames long (indexed with a mask) and sized
+// for the longest delay among its bins; tiles that are never delayed take no memory.
+// Each bin keeps its own write position, which only moves on frames where it is delayed.
+//
+// Samples can instead be stored as IEEE half floats (half a cache line per tile
+// frame), scaled so fullScale maps to 1. That keeps 11 significant bits: each
+// delayed value is within 2^-11 of itself (about -66 dB), or within 2^-25 of full
+// scale for values below 2^-14 of it, and anything above 65504x full scale is clamped.
+//
+// New lines can take over from old ones without losing the echoes in flight: see
+// continueFrom.
+class BinDelayArena
+{
+public:
+    static constexpr int kTileBins = 8; // 8 complex floats = 64 bytes
+
+    BinDelayArena() = default;
+
+    // Allocates (and clears) rings that can delay each bin by up to
+    // maxDelayFrames[bin] frames (one entry per bin). Not real-time safe.
+    void allocate(const std::vector<int>& maxDelayFrames, bool halfPrecision = false, float fullScale = 1.0f);
+
+    void clear();
+
+    // Longest delay bin can take; 0 where it has no ring
+    int getMaxDelayFrames(int bin) const { return tiles[static_cast<size_t>(bin / kTileBins)].mask; }
+    int getLongestDelayFrames() const;
+
+    bool isHalfPrecision() const { return sampleBytes == sizeof(uint16_t); }
+    size_t getNumBytes() const { return storage.size(); }
+
+    // Delay one frame of bins [begin, end) in place: where delayFrames[bin] > 0 the
+    // bin's sample goes into its ring and the one written that many frames ago
+    // comes out. delayFrames[bin] must not exceed getMaxDelayFrames(bin).
+    void process(float* re, float* im, const int* delayFrames, int begin, int end);
+
+    // Carry on from previous's history (call between frames, on a freshly allocated
+    // arena): delays reaching back before the switch read previous's rings until
+    // this arena has recorded that far itself. previous must stay alive, and not
+    // process, until releasePrevious(); after getLongestDelayFrames() + 1 frames no
+    // bin that kept being delayed reads it any more. A bin records only the frames
+    // it is delayed on, so one left undelayed across that span loses the rest.
+    void continueFrom(const BinDelayArena& previous);
+    void releasePrevious() { previous = nullptr; }
+
+    // Float <-> IEEE half conversion (round to nearest even) of n values, with F16C
+    // where the CPU has it. Out-of-range floats become infinities.
+    static void floatToHalf(const float* src, uint16_t* dest, int n);
+    static void halfToFloat(const uint16_t* src, float* dest, int n);
+
+private:
+    struct Tile
+    {
+        size_t offset = 0; // first byte of the tile's ring
+        int mask = 0;      // ring frames - 1
+    };
+
+    std::vector<uint8_t> storage;
+    uint8_t* frames = nullptr; // storage, aligned to a cache line
+    size_t sampleBytes = sizeof(float);
+    float halfScale = 1.0f; // stored = sample * halfScale
+    std::vector<Tile> tiles;
+    std::vector<int> writePos;
+
+    const BinDelayArena* previous = nullptr;
+    std::vector<int> framesRecorded; // per bin, since continueFrom (saturates at the ring length)
+
+    uint8_t* getSlot(int bin, int frame) const
+    {
+        return frames + tiles[static_cast<size_t>(bin / kTileBins)].offset
+                      + (static_cast<size_t>(frame) * kTileBins + static_cast<size_t>(bin % kTileBins)) * 2 * sampleBytes;
+    }
+
+    void readSample(int bin, int frame, float* sample) const;
+    void writeSample(int bin, int frame, float re, float im);
+
+    void processFloat(float* re, float* im, const int* delayFrames, int begin, int end);
+    void processHalf(float* re, float* im, const int* delayFrames, int begin, int end);
+    void processContinuing(float* re, float* im, const int* delayFrames, int begin, int end);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinDelayArena)
+};
@@ -0,0 +1,47 @@
+#include "CurveTables.h"
+#include <algorithm>
+#include <cmath>
+
+void CurveTables::allocate(const CurveTableLayout& newLayout)
+{
+    layout = newLayout;
+    for (auto& bank : curves)
+        for (auto& curve : bank)
+            curve.resize(static_cast<size_t>(layout.getNumBins()));
+}
+
+void CurveTables::compile(const std::array<Bank, 4>& banks)
+{
+    for (size_t b = 0; b < banks.size(); ++b)
+    {
+        for (int c = 0; c < kNumCurves; ++c)
+        {
+            fillCurve(banks[b].getCurve(static_cast<CurveType>(c)), layout, curves[b][static_cast<size_t>(c)].data());
+            ids[b][static_cast<size_t>(c)] = getNextId();
+        }
+    }
+}
+
+void CurveTables::fillCurve(const PiecewiseFunction& curve, const CurveTableLayout& layout, float* dest)
+{
+    // Curves span 20 Hz to the curve rate's Nyquist on a log axis
+    const float minFreq = 20.0f;
+    const float logMin = std::log10(minFreq);
+    const float nyquist = static_cast<float>(layout.curveSampleRate) / 2.0f;
+    const float logRange = std::log10(nyquist) - logMin;
+    const float logRangeInv = (logRange > 0.0f) ? (1.0f / logRange) : 1.0f;
+    const float binFreqStep = static_cast<float>(layout.sampleRate) / static_cast<float>(layout.fftSize);
+
+    for (int bin = 0; bin < layout.getNumBins(); ++bin)
+    {
+        float freq = bin * binFreqStep;
+        float normalizedFreq;
+        if (freq < minFreq)
+            normalizedFreq = 0.0f;
+        else
+            normalizedFreq = (std::log10(freq) - logMin) * logRangeInv;
+
+        normalizedFreq = std::clamp(normalizedFreq, 0.0f, 1.0f);
+        dest[bin] = curve.evaluate(normalizedFreq);
+    }
+}
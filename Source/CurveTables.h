@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Bank.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Where an engine's bins fall on the curves' frequency axis. Engines with the same
+// layout read the same tables.
+struct CurveTableLayout
+{
+    double sampleRate = 0.0;      // rate the bins are spaced at
+    double curveSampleRate = 0.0; // rate the curves' (log) frequency axis spans
+    int fftSize = 0;
+
+    int getNumBins() const { return fftSize / 2; }
+
+    bool operator==(const CurveTableLayout& other) const
+    {
+        return sampleRate == other.sampleRate && curveSampleRate == other.curveSampleRate
+            && fftSize == other.fftSize;
+    }
+    bool operator!=(const CurveTableLayout& other) const { return !(*this == other); }
+};
+
+// Every curve of all four banks evaluated at each bin of one layout: raw
+// normalized values (0-1), which the engine morphs between per frame.
+struct CurveTables
+{
+    static constexpr int kNumCurves = 16;
+
+    CurveTableLayout layout;
+    std::array<std::array<std::vector<float>, kNumCurves>, 4> curves; // [bank][CurveType]
+
+    // Identifies each table's contents: a table gets a new id whenever it is
+    // filled, and keeps it when copied, so equal ids mean equal values
+    std::array<std::array<uint64_t, kNumCurves>, 4> ids {};
+
+    static uint64_t getNextId() { return ++lastId; }
+
+    // Size every table for the layout (contents undefined until filled)
+    void allocate(const CurveTableLayout& newLayout);
+
+    // Evaluate every curve of every bank
+    void compile(const std::array<Bank, 4>& banks);
+
+    // Evaluate one curve at each of the layout's bins into dest (getNumBins() floats)
+    static void fillCurve(const PiecewiseFunction& curve, const CurveTableLayout& layout, float* dest);
+
+private:
+    static inline std::atomic<uint64_t> lastId { 0 };
+};
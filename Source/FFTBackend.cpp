@@ -0,0 +1,319 @@
+#include "FFTBackend.h"
+#include "MixedRadixFFT.h"
+#include "DebugLogger.h"
+#if SPECTRASAURUS_HAS_PFFFT
+ #include "PffftBackend.h"
+#endif
+#include <limits>
+#include <map>
+#include <mutex>
+
+//==============================================================================
+FFTBackend::FFTBackend(int fftSize)
+    : size(fftSize),
+      realScratchIn(static_cast<size_t>(fftSize)),
+      realScratchOut(static_cast<size_t>(fftSize))
+{
+}
+
+void FFTBackend::performRealOnlyForwardTransform(float* data)
+{
+    for (int i = 0; i < size; ++i)
+        realScratchIn[i] = Complex(data[i], 0.0f);
+
+    perform(realScratchIn.data(), realScratchOut.data(), false);
+
+    for (int i = 0; i < size; ++i)
+    {
+        data[2 * i] = realScratchOut[i].real();
+        data[2 * i + 1] = realScratchOut[i].imag();
+    }
+}
+
+void FFTBackend::performRealOnlyInverseTransform(float* data)
+{
+    // Bins 0..size/2 are used; the upper half is rebuilt by conjugate symmetry
+    const int half = size / 2;
+    for (int i = 0; i <= half; ++i)
+        realScratchIn[i] = Complex(data[2 * i], data[2 * i + 1]);
+    for (int i = half + 1; i < size; ++i)
+        realScratchIn[i] = std::conj(realScratchIn[size - i]);
+
+    perform(realScratchIn.data(), realScratchOut.data(), true);
+
+    for (int i = 0; i < size; ++i)
+        data[i] = realScratchOut[i].real();
+}
+
+//==============================================================================
+JuceFFTBackend::JuceFFTBackend(int fftSize)
+    : FFTBackend(fftSize),
+      fft(juce::roundToInt(std::log2(fftSize)))
+{
+}
+
+void JuceFFTBackend::perform(const Complex* in, Complex* out, bool inverse)
+{
+    fft.perform(in, out, inverse);
+}
+
+void JuceFFTBackend::performRealOnlyForwardTransform(float* data)
+{
+    fft.performRealOnlyForwardTransform(data);
+}
+
+void JuceFFTBackend::performRealOnlyInverseTransform(float* data)
+{
+    fft.performRealOnlyInverseTransform(data);
+}
+
+//==============================================================================
+namespace
+{
+// Per-machine cache of the benchmark winners:
+// { "cpu": ..., "backends": { "<size> <kind>": "<name>" } }
+juce::File getBenchmarkCacheFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Spectrasaurus")
+        .getChildFile("FFTBackends.json");
+}
+
+juce::String getMachineId()
+{
+    return juce::SystemStats::getCpuVendor() + " " + juce::SystemStats::getCpuModel();
+}
+
+juce::String getCacheKey(int size, FFTBackend::FrameKind kind)
+{
+    return juce::String(size) + (kind == FFTBackend::FrameKind::PackedComplex ? " packed" : " real");
+}
+
+std::mutex cacheMutex;
+std::map<juce::String, juce::String> fastestByKey;
+bool cacheFileLoaded = false;
+
+void loadCacheFile()
+{
+    auto parsed = juce::JSON::parse(getBenchmarkCacheFile().loadFileAsString());
+    auto* root = parsed.getDynamicObject();
+    if (root == nullptr || root->getProperty("cpu").toString() != getMachineId())
+        return; // missing, unreadable, or written on a different CPU
+
+    // Entries from before the kind was part of the key ("<size>") are dropped
+    if (auto* backends = root->getProperty("backends").getDynamicObject())
+        for (auto& entry : backends->getProperties())
+            if (entry.name.toString().contains(" "))
+                fastestByKey[entry.name.toString()] = entry.value.toString();
+}
+
+void saveCacheFile()
+{
+    auto* backends = new juce::DynamicObject();
+    for (auto& [key, name] : fastestByKey)
+        backends->setProperty(key, name);
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", getMachineId());
+    root->setProperty("backends", juce::var(backends));
+
+    auto file = getBenchmarkCacheFile();
+    file.getParentDirectory().createDirectory();
+    file.replaceWithText(juce::JSON::toString(juce::var(root)));
+}
+
+// True if the backend's forward transforms (complex and real-only) give the
+// spectrum the mixed-radix FFT does. The round trip in timeBackend can't catch a
+// wrong layout, sign or scale that the inverse undoes.
+bool matchesReference(FFTBackend& backend)
+{
+    using Complex = FFTBackend::Complex;
+    const int n = backend.getSize();
+    std::vector<Complex> input(static_cast<size_t>(n)), realInput(input), expected(input), expectedReal(input), actual(input);
+    std::vector<float> realData(2 * static_cast<size_t>(n));
+
+    juce::Random random(0xfee1);
+    for (int i = 0; i < n; ++i)
+    {
+        input[i] = Complex(random.nextFloat() * 2.0f - 1.0f, random.nextFloat() * 2.0f - 1.0f);
+        realInput[i] = Complex(input[i].real(), 0.0f);
+        realData[i] = input[i].real();
+    }
+
+    MixedRadixFFT reference(n);
+    reference.perform(input.data(), expected.data(), false);
+    reference.perform(realInput.data(), expectedReal.data(), false);
+    backend.perform(input.data(), actual.data(), false);
+    backend.performRealOnlyForwardTransform(realData.data());
+
+    // Random input gives bins of about sqrt(n); float error is well under 1e-5 of that
+    const float tolerance = 1.0e-4f * std::sqrt(static_cast<float>(n));
+    for (int i = 0; i < n; ++i)
+    {
+        if (std::abs(actual[i] - expected[i]) > tolerance)
+            return false;
+        if (i <= n / 2 && std::abs(Complex(realData[2 * i], realData[2 * i + 1]) - expectedReal[i]) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+// Seconds for one stereo frame of the given kind (forward and inverse on both
+// channels), best of several runs. Negative if the backend gives wrong results.
+double timeBackend(FFTBackend& backend, FFTBackend::FrameKind kind)
+{
+    const int n = backend.getSize();
+    std::vector<FFTBackend::Complex> input(static_cast<size_t>(n)), freq(input), output(input);
+    std::vector<float> left(2 * static_cast<size_t>(n)), right(left);
+
+    juce::Random random(0x5eed);
+    for (auto& c : input)
+        c = FFTBackend::Complex(random.nextFloat() * 2.0f - 1.0f, random.nextFloat() * 2.0f - 1.0f);
+
+    auto loadChannels = [&]
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            left[i] = input[i].real();
+            right[i] = input[i].imag();
+        }
+    };
+
+    auto runFrame = [&]
+    {
+        if (kind == FFTBackend::FrameKind::PackedComplex)
+        {
+            backend.perform(input.data(), freq.data(), false);
+            backend.perform(freq.data(), output.data(), true);
+        }
+        else
+        {
+            loadChannels();
+            backend.performRealOnlyForwardTransform(left.data());
+            backend.performRealOnlyForwardTransform(right.data());
+            backend.performRealOnlyInverseTransform(left.data());
+            backend.performRealOnlyInverseTransform(right.data());
+        }
+    };
+
+    // Round trip must reproduce the input
+    runFrame();
+    for (int i = 0; i < n; ++i)
+    {
+        const auto result = kind == FFTBackend::FrameKind::PackedComplex ? output[i]
+                                                                         : FFTBackend::Complex(left[i], right[i]);
+        if (std::abs(result - input[i]) > 1.0e-3f)
+            return -1.0;
+    }
+
+    // Enough iterations for a stable reading, a few milliseconds per backend
+    const int iterations = std::max(4, 65536 / n);
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 3; ++run)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < iterations; ++i)
+            runFrame();
+        auto ticks = juce::Time::getHighResolutionTicks() - start;
+        best = std::min(best, static_cast<double>(ticks) / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / iterations);
+    }
+    return best;
+}
+
+juce::String benchmarkFastest(int size, FFTBackend::FrameKind kind)
+{
+    juce::String fastest;
+    double fastestTime = std::numeric_limits<double>::max();
+
+    for (auto& name : FFTBackend::getBackendNames())
+    {
+        auto backend = FFTBackend::create(name, size);
+        if (backend == nullptr)
+            continue;
+
+        if (!matchesReference(*backend))
+        {
+            DEBUG_LOG("FFT benchmark ", getCacheKey(size, kind), ": ", name, " gives the wrong spectrum, skipped");
+            continue;
+        }
+
+        double t = timeBackend(*backend, kind);
+        DEBUG_LOG("FFT benchmark ", getCacheKey(size, kind), ": ", name, " ", t * 1.0e6, " us/frame");
+        if (t >= 0.0 && t < fastestTime)
+        {
+            fastestTime = t;
+            fastest = name;
+        }
+    }
+    return fastest;
+}
+} // namespace
+
+juce::StringArray FFTBackend::getBackendNames()
+{
+    // PFFFT last: it only takes over where it's measurably faster
+    juce::StringArray names { "JUCE", "MixedRadix" };
+   #if SPECTRASAURUS_HAS_PFFFT
+    names.add("PFFFT");
+   #endif
+    return names;
+}
+
+std::unique_ptr<FFTBackend> FFTBackend::create(const juce::String& name, int size)
+{
+   #if SPECTRASAURUS_HAS_PFFFT
+    if (name == "PFFFT" && PffftBackend::supportsSize(size))
+    {
+        auto backend = std::make_unique<PffftBackend>(size);
+        return backend->isPrepared() ? std::move(backend) : nullptr;
+    }
+   #endif
+    if (name == "JUCE" && JuceFFTBackend::supportsSize(size))
+        return std::make_unique<JuceFFTBackend>(size);
+    if (name == "MixedRadix" && MixedRadixFFT::supportsSize(size))
+        return std::make_unique<MixedRadixFFT>(size);
+    return nullptr;
+}
+
+bool FFTBackend::isSupportedSize(int size)
+{
+    // MixedRadix takes any size; the others are only ever faster alternatives
+    return JuceFFTBackend::supportsSize(size) || MixedRadixFFT::supportsSize(size);
+}
+
+std::unique_ptr<FFTBackend> FFTBackend::createFastest(int size, FrameKind kind)
+{
+    auto forced = juce::SystemStats::getEnvironmentVariable("SPECTRASAURUS_FFT_BACKEND", {});
+    if (forced.isNotEmpty())
+        if (auto backend = create(forced, size))
+            return backend;
+
+    juce::String name;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        if (!cacheFileLoaded)
+        {
+            loadCacheFile();
+            cacheFileLoaded = true;
+        }
+
+        const auto key = getCacheKey(size, kind);
+        auto it = fastestByKey.find(key);
+        if (it != fastestByKey.end() && getBackendNames().contains(it->second))
+        {
+            name = it->second;
+        }
+        else
+        {
+            name = benchmarkFastest(size, kind);
+            fastestByKey[key] = name;
+            saveCacheFile();
+        }
+    }
+
+    if (auto backend = create(name, size))
+        return backend;
+
+    return std::make_unique<MixedRadixFFT>(size);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+#include <vector>
+
+// Complex FFT of a fixed size, with the conventions of juce::dsp::FFT:
+// forward is unscaled, inverse is scaled by 1/N, and the real-only transforms
+// use JUCE's interleaved layout (2 * size floats, bins 0..size/2 valid).
+//
+// Backends are created by name. createFastest() picks the quickest backend that
+// supports a size (and gives the same spectrum as MixedRadixFFT) by timing the
+// candidates once per size and kind of transform; the result is cached in memory
+// and in a per-machine file so later instances skip the benchmark.
+class FFTBackend
+{
+public:
+    using Complex = juce::dsp::Complex<float>;
+
+    virtual ~FFTBackend() = default;
+
+    virtual const char* getName() const = 0;
+    int getSize() const { return size; }
+
+    // out must not alias in
+    virtual void perform(const Complex* in, Complex* out, bool inverse) = 0;
+
+    // Default implementations go through perform(); backends with a native real
+    // transform override these
+    virtual void performRealOnlyForwardTransform(float* data);
+    virtual void performRealOnlyInverseTransform(float* data);
+
+    // What a stereo frame runs: one complex transform each way with both channels
+    // packed into it, or the real-only transforms on each channel
+    enum class FrameKind
+    {
+        PackedComplex,
+        RealOnly
+    };
+
+    // Backend names, in order of preference when timings tie
+    static juce::StringArray getBackendNames();
+
+    // nullptr if the backend doesn't exist or can't handle this size
+    static std::unique_ptr<FFTBackend> create(const juce::String& name, int size);
+
+    // Fastest supported backend for this size and kind of frame on this machine.
+    // The SPECTRASAURUS_FFT_BACKEND environment variable forces a backend by name.
+    static std::unique_ptr<FFTBackend> createFastest(int size, FrameKind kind);
+
+    // True if some backend can transform this size
+    static bool isSupportedSize(int size);
+
+protected:
+    explicit FFTBackend(int fftSize);
+
+    int size;
+
+private:
+    std::vector<Complex> realScratchIn, realScratchOut;
+};
+
+// juce::dsp::FFT (platform FFT where JUCE has one). Power-of-two sizes only.
+class JuceFFTBackend : public FFTBackend
+{
+public:
+    explicit JuceFFTBackend(int fftSize);
+
+    const char* getName() const override { return "JUCE"; }
+    void perform(const Complex* in, Complex* out, bool inverse) override;
+    void performRealOnlyForwardTransform(float* data) override;
+    void performRealOnlyInverseTransform(float* data) override;
+
+    static bool supportsSize(int size) { return size >= 2 && juce::isPowerOfTwo(size); }
+
+private:
+    juce::dsp::FFT fft;
+};
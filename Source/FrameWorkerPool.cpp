@@ -0,0 +1,291 @@
+#include "FrameWorkerPool.h"
+#include "DebugLogger.h"
+#include <algorithm>
+#include <mutex>
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #include <immintrin.h>
+#endif
+
+namespace
+{
+// Polls for the next job before a worker goes to sleep, one pause apart. The
+// budget adapts per worker between these bounds: it doubles when a job turns up
+// while spinning and halves when the worker ends up sleeping anyway, so workers
+// only keep spinning while frames really do post jobs back to back. At the
+// maximum that's a few tens of microseconds.
+constexpr int kMinWorkerSpinIterations = 16;
+constexpr int kMaxWorkerSpinIterations = 1024;
+
+// Under SCHED_FIFO a spinning worker keeps every lower-priority thread off its
+// core, so it spins a much shorter while and yields every few polls
+constexpr int kMaxFifoWorkerSpinIterations = 128;
+constexpr int kFifoYieldInterval = 16;
+
+// Polls by the caller (one pause apart) for tasks still running on workers before
+// it starts yielding
+constexpr int kJoinSpinIterations = 4096;
+
+// SCHED_FIFO priority for the workers when Options::fifoPriority is set
+constexpr int kFifoPriority = 70;
+
+std::mutex sharedPoolMutex;
+std::weak_ptr<FrameWorkerPool> sharedPool;
+
+// Tells the core we're in a spin-wait (frees the pipeline for a hyper-thread
+// sibling and saves power)
+inline void spinPause()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+} // namespace
+
+class FrameWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(FrameWorkerPool& p, int workerIndex, const Options& o)
+        : juce::Thread("Spectrasaurus frame worker " + juce::String(workerIndex)),
+          pool(p), index(workerIndex), options(o) {}
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeEvent.signal();
+        stopThread(2000);
+    }
+
+    // Called by a job's poster after it opened the job
+    void wake()
+    {
+        if (sleeping.load())
+            wakeEvent.signal();
+    }
+
+    void run() override
+    {
+        applySchedulingOptions();
+
+        Generations seen {};
+        while (!threadShouldExit())
+        {
+            if (pool.hasNewJob(seen))
+            {
+                pool.workOnJobs(index, seen);
+                continue;
+            }
+
+            if (spinForJob(seen))
+                continue;
+
+            // Publish that we're going to sleep, then check once more, so a job
+            // opened in between either gets seen here or signals the event
+            sleeping = true;
+            if (!pool.hasNewJob(seen))
+                wakeEvent.wait(100);
+            sleeping = false;
+        }
+    }
+
+private:
+    FrameWorkerPool& pool;
+    const int index;
+    const Options options;
+    juce::WaitableEvent wakeEvent;
+    std::atomic<bool> sleeping { false };
+    int spinIterations = kMinWorkerSpinIterations;
+
+    // Polls for a new job for up to spinIterations pauses, and adapts the budget
+    bool spinForJob(const Generations& seen)
+    {
+        const int maxIterations = options.fifoPriority ? kMaxFifoWorkerSpinIterations : kMaxWorkerSpinIterations;
+        for (int spin = 0; spin < spinIterations; ++spin)
+        {
+            if (pool.hasNewJob(seen))
+            {
+                spinIterations = std::min(2 * spinIterations, maxIterations);
+                return true;
+            }
+
+            spinPause();
+            if (options.fifoPriority && spin % kFifoYieldInterval == kFifoYieldInterval - 1)
+                juce::Thread::yield();
+        }
+
+        spinIterations = std::max(spinIterations / 2, kMinWorkerSpinIterations);
+        return false;
+    }
+
+    void applySchedulingOptions()
+    {
+#if JUCE_LINUX
+        if (options.fifoPriority)
+        {
+            sched_param param {};
+            param.sched_priority = juce::jlimit(sched_get_priority_min(SCHED_FIFO),
+                                                sched_get_priority_max(SCHED_FIFO), kFifoPriority);
+            if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+                DEBUG_LOG("Frame worker ", index, ": SCHED_FIFO refused, keeping the default policy");
+        }
+
+        if (options.pinToCores)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET((index + 1) % juce::SystemStats::getNumCpus(), &cpus);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+                DEBUG_LOG("Frame worker ", index, ": couldn't pin to a CPU");
+        }
+#endif
+    }
+};
+
+FrameWorkerPool::FrameWorkerPool(const Options& options)
+{
+    for (int i = 0; i < options.numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, i, options));
+        workers.back()->startRealtimeThread(juce::Thread::RealtimeOptions{});
+    }
+}
+
+FrameWorkerPool::~FrameWorkerPool()
+{
+    workers.clear();
+}
+
+std::shared_ptr<FrameWorkerPool> FrameWorkerPool::getShared(const Options& options)
+{
+    std::lock_guard<std::mutex> lock(sharedPoolMutex);
+
+    auto pool = sharedPool.lock();
+    if (pool == nullptr)
+    {
+        pool = std::make_shared<FrameWorkerPool>(options);
+        sharedPool = pool;
+        DEBUG_LOG("Shared frame worker pool: ", options.numWorkers, " workers");
+    }
+    return pool;
+}
+
+void FrameWorkerPool::runTasks(int numTasks, TaskFunction function, void* context)
+{
+    auto runInline = [&]
+    {
+        for (int task = 0; task < numTasks; ++task)
+            function(context, task);
+    };
+
+    if (workers.empty() || numTasks <= 1)
+    {
+        runInline();
+        return;
+    }
+
+    // Claim a free slot
+    int slot = 0;
+    while (slot < kMaxJobs && (usedJobs.fetch_or(1u << slot) & (1u << slot)) != 0)
+        ++slot;
+    if (slot == kMaxJobs)
+    {
+        runInline();
+        return;
+    }
+
+    const uint32_t bit = 1u << slot;
+    auto& job = jobs[static_cast<size_t>(slot)];
+    const uint32_t generation = job.generation.load() + 1;
+    job.function = function;
+    job.context = context;
+    job.numTasks = numTasks;
+    job.finishedTasks = 0;
+    job.claim = static_cast<uint64_t>(generation) << 32;
+    job.generation = generation;
+    openJobs.fetch_or(bit);
+
+    for (auto& worker : workers)
+        worker->wake();
+
+    // Whatever no worker has claimed yet runs here
+    for (int task = claimTask(job, generation); task >= 0; task = claimTask(job, generation))
+    {
+        function(context, task);
+        ++job.finishedTasks;
+    }
+
+    // Every task is claimed, so the only wait left is for tasks a worker is in the
+    // middle of. A worker that joined but hadn't claimed one finds none left and
+    // isn't waited for, however long it stays descheduled.
+    openJobs.fetch_and(~bit);
+    for (int spin = 0; job.finishedTasks.load() != numTasks; ++spin)
+    {
+        if (spin < kJoinSpinIterations)
+            spinPause();
+        else
+            juce::Thread::yield();
+    }
+
+    usedJobs.fetch_and(~bit);
+}
+
+int FrameWorkerPool::claimTask(Job& job, uint32_t generation)
+{
+    uint64_t claim = job.claim.load();
+    for (;;)
+    {
+        // A different generation means this job is over and its slot reused; the
+        // compare-exchange below fails on any such change, so numTasks can't be stale
+        const int task = static_cast<int>(claim & 0xffffffffu);
+        if (static_cast<uint32_t>(claim >> 32) != generation || task >= job.numTasks)
+            return -1;
+        if (job.claim.compare_exchange_weak(claim, claim + 1))
+            return task;
+    }
+}
+
+bool FrameWorkerPool::hasNewJob(const Generations& seen) const
+{
+    const uint32_t open = openJobs.load();
+    for (int slot = 0; slot < kMaxJobs; ++slot)
+        if ((open & (1u << slot)) != 0
+            && jobs[static_cast<size_t>(slot)].generation.load() != seen[static_cast<size_t>(slot)])
+            return true;
+    return false;
+}
+
+void FrameWorkerPool::workOnJobs(int firstSlot, Generations& seen)
+{
+    // Workers start at different slots, so with several jobs open they spread out
+    // instead of all piling onto the first
+    for (int i = 0; i < kMaxJobs; ++i)
+    {
+        const int slot = (firstSlot + i) % kMaxJobs;
+        auto& seenGeneration = seen[static_cast<size_t>(slot)];
+        if ((openJobs.load() & (1u << slot)) != 0
+            && jobs[static_cast<size_t>(slot)].generation.load() != seenGeneration)
+            workOnJob(slot, seenGeneration);
+    }
+}
+
+void FrameWorkerPool::workOnJob(int slot, uint32_t& seenGeneration)
+{
+    auto& job = jobs[static_cast<size_t>(slot)];
+
+    // The poster only waits for tasks claimed here, and a claimed task keeps the
+    // job (and its function and context) alive until it's finished
+    const uint32_t generation = job.generation.load();
+    seenGeneration = generation;
+    for (int task = claimTask(job, generation); task >= 0; task = claimTask(job, generation))
+    {
+        job.function(job.context, task);
+        ++job.finishedTasks;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Real-time helper threads that share out the independent per-pair and per-bin
+// work of FFT frames, so a large frame can use several cores instead of only the
+// thread that runs it.
+//
+// run() posts a job of numTasks tasks, works on it on the calling thread too, and
+// returns once every task has finished. Tasks are claimed one at a time from the
+// job's counter, and the caller runs every task no worker has claimed, so it never
+// waits on a worker that was woken but hasn't started (or got descheduled before
+// claiming anything). It only waits for tasks a worker is already running: a
+// bounded spin, then yielding.
+// Workers poll for a short while after each job, since a frame posts several
+// back to back, then sleep until the next one. How long they poll adapts to how
+// often a job actually turns up in time (see kMaxWorkerSpinIterations).
+//
+// Several threads may post at once (every plugin instance in the process shares
+// one pool, see getShared()). Each open job has a slot; an idle worker takes tasks
+// from whichever slot still has some, starting from a different slot per worker,
+// so the workers drift to whichever instances have work. With every slot taken
+// run() just works through its tasks inline.
+class FrameWorkerPool
+{
+public:
+    struct Options
+    {
+        int numWorkers = 0;
+        bool fifoPriority = false; // Linux: SCHED_FIFO instead of the default real-time policy
+        bool pinToCores = false;   // Linux: worker i runs on CPU i + 1 only
+    };
+
+    explicit FrameWorkerPool(const Options& options);
+    ~FrameWorkerPool();
+
+    // The process-wide pool. The first caller creates it with its options; later
+    // callers share it (their options are ignored) until the last reference goes.
+    static std::shared_ptr<FrameWorkerPool> getShared(const Options& options);
+
+    int getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+    // Calls fn(taskIndex) for every taskIndex in [0, numTasks); fn must be safe
+    // to call concurrently for different tasks. Runs inline without workers.
+    template <typename Fn>
+    void run(int numTasks, Fn&& fn)
+    {
+        using Callable = std::remove_reference_t<Fn>;
+        runTasks(numTasks, [](void* context, int task) { (*static_cast<Callable*>(context))(task); },
+                 const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+private:
+    using TaskFunction = void (*)(void* context, int task);
+
+    static constexpr int kMaxJobs = 32; // bits of the slot masks
+
+    // A slot's fields are written while its openJobs bit is clear. function and
+    // context are only read by a thread holding a claimed task of the job, which
+    // keeps the slot from being reused. One cache line each, so instances posting
+    // at once don't contend.
+    struct alignas(64) Job
+    {
+        TaskFunction function = nullptr;
+        void* context = nullptr;
+        std::atomic<int> numTasks { 0 };
+        std::atomic<uint32_t> generation { 0 }; // bumped for every job, so a worker joins each once
+        std::atomic<uint64_t> claim { 0 };      // generation << 32 | next unclaimed task
+        std::atomic<int> finishedTasks { 0 };
+    };
+
+    using Generations = std::array<uint32_t, kMaxJobs>; // per slot, the last job a worker joined
+
+    class Worker;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::array<Job, kMaxJobs> jobs;
+    std::atomic<uint32_t> usedJobs { 0 }; // slots claimed by a poster
+    std::atomic<uint32_t> openJobs { 0 }; // slots whose tasks workers may claim
+
+    void runTasks(int numTasks, TaskFunction function, void* context);
+    static int claimTask(Job& job, uint32_t generation); // -1 once none are left
+    bool hasNewJob(const Generations& seen) const;
+    void workOnJobs(int firstSlot, Generations& seen);
+    void workOnJob(int slot, uint32_t& seenGeneration);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameWorkerPool)
+};
@@ -0,0 +1,240 @@
+// Adapted from KissFFT, Copyright (c) 2003-2010, Mark Borgerding. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+// See THIRD_PARTY_NOTICES.md for the full license text.
+
+#include "MixedRadixFFT.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+
+namespace
+{
+using Complex = FFTBackend::Complex;
+
+// Plain complex arithmetic (std::complex's operator* carries inf/NaN recovery
+// that is far slower than needed here)
+inline Complex cmul(Complex a, Complex b)
+{
+    return { a.real() * b.real() - a.imag() * b.imag(),
+             a.real() * b.imag() + a.imag() * b.real() };
+}
+inline Complex cadd(Complex a, Complex b) { return { a.real() + b.real(), a.imag() + b.imag() }; }
+inline Complex csub(Complex a, Complex b) { return { a.real() - b.real(), a.imag() - b.imag() }; }
+inline Complex cscale(Complex a, float s) { return { a.real() * s, a.imag() * s }; }
+} // namespace
+
+MixedRadixFFT::MixedRadixFFT(int fftSize)
+    : FFTBackend(fftSize),
+      plan(getSharedPlan(fftSize))
+{
+    genericScratch.resize(static_cast<size_t>(plan->maxRadix));
+}
+
+std::shared_ptr<const MixedRadixFFT::Plan> MixedRadixFFT::getSharedPlan(int size)
+{
+    static std::mutex mutex;
+    static std::map<int, std::weak_ptr<const Plan>> plans;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& entry = plans[size];
+    if (auto existing = entry.lock())
+        return existing;
+
+    auto built = std::make_shared<Plan>();
+
+    // Factor: radix 4 first, then 2, 3, 5 and any remaining odd primes
+    int n = size;
+    int p = 4;
+    const int floorSqrt = static_cast<int>(std::floor(std::sqrt(static_cast<double>(n))));
+    do
+    {
+        while (n % p != 0)
+        {
+            switch (p)
+            {
+                case 4: p = 2; break;
+                case 2: p = 3; break;
+                default: p += 2; break;
+            }
+            if (p > floorSqrt)
+                p = n;
+        }
+        n /= p;
+        built->factors.push_back(p);
+        built->factors.push_back(n);
+        built->maxRadix = std::max(built->maxRadix, p);
+    } while (n > 1);
+
+    built->forwardTwiddles.resize(static_cast<size_t>(size));
+    built->inverseTwiddles.resize(static_cast<size_t>(size));
+    for (int i = 0; i < size; ++i)
+    {
+        double phase = -2.0 * juce::MathConstants<double>::pi * i / size;
+        built->forwardTwiddles[i] = Complex(static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase)));
+        built->inverseTwiddles[i] = std::conj(built->forwardTwiddles[i]);
+    }
+
+    entry = built;
+    return built;
+}
+
+void MixedRadixFFT::perform(const Complex* in, Complex* out, bool inverse)
+{
+    work(out, in, 1, plan->factors.data(), inverse);
+
+    if (inverse)
+    {
+        const float scale = 1.0f / static_cast<float>(size);
+        for (int i = 0; i < size; ++i)
+            out[i] = cscale(out[i], scale);
+    }
+}
+
+void MixedRadixFFT::work(Complex* out, const Complex* in, int fstride, const int* f, bool inverse)
+{
+    const int p = f[0]; // radix of this stage
+    const int m = f[1]; // length of each sub-transform
+    Complex* const outBegin = out;
+    Complex* const outEnd = out + p * m;
+
+    if (m == 1)
+    {
+        // Leaf: gather the decimated inputs
+        for (; out != outEnd; ++out, in += fstride)
+            *out = *in;
+    }
+    else
+    {
+        // p sub-transforms of length m, each over every p-th input
+        for (; out != outEnd; out += m, in += fstride)
+            work(out, in, fstride * p, f + 2, inverse);
+    }
+
+    const Complex* tw = inverse ? plan->inverseTwiddles.data() : plan->forwardTwiddles.data();
+    switch (p)
+    {
+        case 2:  butterfly2(outBegin, fstride, m, tw); break;
+        case 3:  butterfly3(outBegin, fstride, m, tw); break;
+        case 4:  butterfly4(outBegin, fstride, m, tw, inverse); break;
+        case 5:  butterfly5(outBegin, fstride, m, tw); break;
+        default: butterflyGeneric(outBegin, fstride, m, p, tw); break;
+    }
+}
+
+void MixedRadixFFT::butterfly2(Complex* out, int fstride, int m, const Complex* tw)
+{
+    Complex* out2 = out + m;
+    for (int k = 0; k < m; ++k)
+    {
+        Complex t = cmul(out2[k], tw[k * fstride]);
+        out2[k] = csub(out[k], t);
+        out[k] = cadd(out[k], t);
+    }
+}
+
+void MixedRadixFFT::butterfly3(Complex* out, int fstride, int m, const Complex* tw)
+{
+    const float epi3Imag = tw[fstride * m].imag();
+    for (int k = 0; k < m; ++k)
+    {
+        Complex s1 = cmul(out[k + m], tw[k * fstride]);
+        Complex s2 = cmul(out[k + 2 * m], tw[2 * k * fstride]);
+        Complex s3 = cadd(s1, s2);
+        Complex s0 = cscale(csub(s1, s2), epi3Imag);
+
+        Complex mid = csub(out[k], cscale(s3, 0.5f));
+        out[k] = cadd(out[k], s3);
+        out[k + 2 * m] = Complex(mid.real() + s0.imag(), mid.imag() - s0.real());
+        out[k + m]     = Complex(mid.real() - s0.imag(), mid.imag() + s0.real());
+    }
+}
+
+void MixedRadixFFT::butterfly4(Complex* out, int fstride, int m, const Complex* tw, bool inverse)
+{
+    for (int k = 0; k < m; ++k)
+    {
+        Complex s0 = cmul(out[k + m], tw[k * fstride]);
+        Complex s1 = cmul(out[k + 2 * m], tw[2 * k * fstride]);
+        Complex s2 = cmul(out[k + 3 * m], tw[3 * k * fstride]);
+
+        Complex s5 = csub(out[k], s1);
+        Complex s0p = cadd(out[k], s1);
+        Complex s3 = cadd(s0, s2);
+        Complex s4 = csub(s0, s2);
+
+        out[k + 2 * m] = csub(s0p, s3);
+        out[k] = cadd(s0p, s3);
+
+        if (inverse)
+        {
+            out[k + m]     = Complex(s5.real() - s4.imag(), s5.imag() + s4.real());
+            out[k + 3 * m] = Complex(s5.real() + s4.imag(), s5.imag() - s4.real());
+        }
+        else
+        {
+            out[k + m]     = Complex(s5.real() + s4.imag(), s5.imag() - s4.real());
+            out[k + 3 * m] = Complex(s5.real() - s4.imag(), s5.imag() + s4.real());
+        }
+    }
+}
+
+void MixedRadixFFT::butterfly5(Complex* out, int fstride, int m, const Complex* tw)
+{
+    const Complex ya = tw[fstride * m];
+    const Complex yb = tw[fstride * 2 * m];
+
+    for (int u = 0; u < m; ++u)
+    {
+        Complex s0 = out[u];
+        Complex s1 = cmul(out[u + m], tw[u * fstride]);
+        Complex s2 = cmul(out[u + 2 * m], tw[2 * u * fstride]);
+        Complex s3 = cmul(out[u + 3 * m], tw[3 * u * fstride]);
+        Complex s4 = cmul(out[u + 4 * m], tw[4 * u * fstride]);
+
+        Complex s7 = cadd(s1, s4);
+        Complex s10 = csub(s1, s4);
+        Complex s8 = cadd(s2, s3);
+        Complex s9 = csub(s2, s3);
+
+        out[u] = Complex(s0.real() + s7.real() + s8.real(), s0.imag() + s7.imag() + s8.imag());
+
+        Complex s5(s0.real() + s7.real() * ya.real() + s8.real() * yb.real(),
+                   s0.imag() + s7.imag() * ya.real() + s8.imag() * yb.real());
+        Complex s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(),
+                   -s10.real() * ya.imag() - s9.real() * yb.imag());
+        out[u + m] = csub(s5, s6);
+        out[u + 4 * m] = cadd(s5, s6);
+
+        Complex s11(s0.real() + s7.real() * yb.real() + s8.real() * ya.real(),
+                    s0.imag() + s7.imag() * yb.real() + s8.imag() * ya.real());
+        Complex s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(),
+                    s10.real() * yb.imag() - s9.real() * ya.imag());
+        out[u + 2 * m] = cadd(s11, s12);
+        out[u + 3 * m] = csub(s11, s12);
+    }
+}
+
+void MixedRadixFFT::butterflyGeneric(Complex* out, int fstride, int m, int p, const Complex* tw)
+{
+    Complex* scratch = genericScratch.data();
+
+    for (int u = 0; u < m; ++u)
+    {
+        for (int q = 0, k = u; q < p; ++q, k += m)
+            scratch[q] = out[k];
+
+        for (int q1 = 0, k = u; q1 < p; ++q1, k += m)
+        {
+            int twIndex = 0;
+            Complex sum = scratch[0];
+            for (int q = 1; q < p; ++q)
+            {
+                twIndex += fstride * k;
+                if (twIndex >= size)
+                    twIndex -= size;
+                sum = cadd(sum, cmul(scratch[q], tw[twIndex]));
+            }
+            out[k] = sum;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// Adapted from KissFFT, Copyright (c) 2003-2010, Mark Borgerding. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+// See THIRD_PARTY_NOTICES.md for the full license text.
+
+#pragma once
+
+#include "FFTBackend.h"
+#include <memory>
+
+// Mixed-radix decimation-in-time complex FFT for any size, after KissFFT's
+// kiss_fft (same factoring and butterflies, with shared plans). Sizes are factored
+// into radix 4, 2, 3 and 5 stages, with a generic (O(p^2)) stage for any other
+// prime factor, so 1536 (2^9 * 3) or 3072 (2^10 * 3) cost about the same as the
+// neighbouring powers of two. All twiddles and scratch are allocated up front;
+// the twiddles are read-only and shared by every instance of the same size.
+class MixedRadixFFT : public FFTBackend
+{
+public:
+    explicit MixedRadixFFT(int fftSize);
+
+    const char* getName() const override { return "MixedRadix"; }
+    void perform(const Complex* in, Complex* out, bool inverse) override;
+
+    static bool supportsSize(int size) { return size >= 2; }
+
+private:
+    void work(Complex* out, const Complex* in, int fstride, const int* factors, bool inverse);
+
+    void butterfly2(Complex* out, int fstride, int m, const Complex* tw);
+    void butterfly3(Complex* out, int fstride, int m, const Complex* tw);
+    void butterfly4(Complex* out, int fstride, int m, const Complex* tw, bool inverse);
+    void butterfly5(Complex* out, int fstride, int m, const Complex* tw);
+    void butterflyGeneric(Complex* out, int fstride, int m, int p, const Complex* tw);
+
+    // Everything that depends only on the size
+    struct Plan
+    {
+        std::vector<int> factors; // (radix, remaining length) pairs, outermost stage first
+        std::vector<Complex> forwardTwiddles, inverseTwiddles;
+        int maxRadix = 0;
+    };
+
+    // The process-wide plan for a size, built by the first caller and freed with
+    // the last reference
+    static std::shared_ptr<const Plan> getSharedPlan(int size);
+
+    std::shared_ptr<const Plan> plan;
+    std::vector<Complex> genericScratch; // ours alone, so instances sharing a plan never race
+};
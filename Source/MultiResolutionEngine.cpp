@@ -0,0 +1,314 @@
+#include "MultiResolutionEngine.h"
+#include "DebugLogger.h"
+#include <cmath>
+
+//==============================================================================
+void MultiResolutionEngine::Decimator::reset(int numChannels)
+{
+    history.assign(static_cast<size_t>(numChannels), std::vector<float>(2 * kFilterTaps, 0.0f));
+    pos = 0;
+}
+
+void MultiResolutionEngine::Decimator::push(const float* const* input, int i)
+{
+    pos = (pos + 1) % kFilterTaps;
+    for (size_t channel = 0; channel < history.size(); ++channel)
+        history[channel][pos] = history[channel][pos + kFilterTaps] = input[channel][i];
+}
+
+void MultiResolutionEngine::Decimator::output(const float* taps, float* const* dest, int i) const
+{
+    // history[pos + 1 .. pos + kFilterTaps] holds the last kFilterTaps inputs,
+    // oldest first; the taps are symmetric so no reversal is needed
+    for (size_t channel = 0; channel < history.size(); ++channel)
+    {
+        const float* h = history[channel].data() + pos + 1;
+        float sum = 0.0f;
+        for (int tap = 0; tap < kFilterTaps; ++tap)
+            sum += taps[tap] * h[tap];
+        dest[channel][i] = sum;
+    }
+}
+
+void MultiResolutionEngine::Interpolator::reset(int numChannels)
+{
+    history.assign(static_cast<size_t>(numChannels), std::vector<float>(2 * kTapsPerPhase, 0.0f));
+    pos = 0;
+}
+
+void MultiResolutionEngine::Interpolator::push(const float* const* input, int i)
+{
+    pos = (pos + 1) % kTapsPerPhase;
+    for (size_t channel = 0; channel < history.size(); ++channel)
+        history[channel][pos] = history[channel][pos + kTapsPerPhase] = input[channel][i];
+}
+
+void MultiResolutionEngine::Interpolator::output(const float* taps, int phase, float* result) const
+{
+    // Zero-stuffed input: only every kDecimation-th tap meets a sample. The newest
+    // low-rate sample is at history[pos + kTapsPerPhase].
+    for (size_t channel = 0; channel < history.size(); ++channel)
+    {
+        const float* h = history[channel].data() + pos + kTapsPerPhase;
+        float sum = 0.0f;
+        for (int i = 0, tap = phase; tap < kFilterTaps; ++i, tap += kDecimation)
+            sum += taps[tap] * h[-i];
+        result[channel] = sum * static_cast<float>(kDecimation);
+    }
+}
+
+//==============================================================================
+MultiResolutionEngine::MultiResolutionEngine(SpectrasaurusAudioProcessor& owner, const Config& engineConfig)
+    : config(engineConfig)
+{
+    const int numBands = juce::jlimit(1, kMaxBands, config.numBands);
+    levels.resize(static_cast<size_t>(numBands));
+    numChannels = juce::jlimit(1, SpectralEngine::kMaxChannels, config.numChannels);
+
+    for (int k = 0; k < numBands; ++k)
+        levels[static_cast<size_t>(k)].engine = std::make_unique<SpectralEngine>(owner, getBandConfig(config, k));
+
+    if (numBands == 1)
+    {
+        latencySamples = levels[0].engine->getLatencySamples();
+        warmupSamples = levels[0].engine->getWarmupSamples();
+        return;
+    }
+
+    // Blackman-windowed sinc, cut off a little below the decimated Nyquist
+    filterTaps.resize(kFilterTaps);
+    const double cutoff = 0.45 / kDecimation; // cycles per sample at the higher rate
+    const double centre = (kFilterTaps - 1) * 0.5;
+    const double pi = juce::MathConstants<double>::pi;
+    double sum = 0.0;
+    for (int i = 0; i < kFilterTaps; ++i)
+    {
+        double x = i - centre;
+        double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+        double window = 0.42 - 0.5 * std::cos(2.0 * pi * i / (kFilterTaps - 1))
+                      + 0.08 * std::cos(4.0 * pi * i / (kFilterTaps - 1));
+        filterTaps[i] = static_cast<float>(sinc * window);
+        sum += filterTaps[i];
+    }
+    for (auto& tap : filterTaps)
+        tap = static_cast<float>(tap / sum);
+
+    // Line the bands up from the bottom: a lower level's output arrives after the
+    // decimation and interpolation filters plus its own latency (at its rate)
+    int lowerLatency = levels.back().engine->getLatencySamples();
+    for (int k = numBands - 2; k >= 0; --k)
+    {
+        auto& level = levels[static_cast<size_t>(k)];
+        level.alignDelaySamples = kDecimation * lowerLatency - level.engine->getLatencySamples();
+        lowerLatency = (kFilterTaps - 1) + kDecimation * lowerLatency;
+
+        level.decimator.reset(numChannels);
+        level.splitInterpolator.reset(numChannels);
+        level.outputInterpolator.reset(numChannels);
+        level.splitDelay.setSize(numChannels, kFilterTaps - 1 + kChunkSize);
+        level.alignDelay.setSize(numChannels, level.alignDelaySamples + kChunkSize);
+
+        for (auto* scratch : { &level.band, &level.bandOut, &level.lowIn, &level.lowOut })
+            scratch->assign(static_cast<size_t>(numChannels), std::vector<float>(kChunkSize, 0.0f));
+    }
+    latencySamples = lowerLatency;
+
+    // The last band fills slowest (its windows are kDecimation^k samples long)
+    auto& last = *levels.back().engine;
+    int lastScale = 1;
+    for (int k = 1; k < numBands; ++k)
+        lastScale *= kDecimation;
+    warmupSamples = latencySamples + lastScale * (last.getConfig().fftSize - last.getHopSize());
+
+    DEBUG_LOG("Band split: ", numBands, " bands, latency ", latencySamples, " samples");
+}
+
+MultiResolutionEngine::Config MultiResolutionEngine::getBandConfig(const Config& config, int band)
+{
+    Config bandConfig = config;
+    bandConfig.curveSampleRate = config.sampleRate;
+    bandConfig.fftSize = getBandFFTSize(config);
+    bandConfig.numBands = 1;
+    for (int k = 0; k < band; ++k)
+    {
+        bandConfig.sampleRate /= kDecimation;
+        bandConfig.maxDelaySamples /= kDecimation;
+    }
+    return bandConfig;
+}
+
+int MultiResolutionEngine::getBandFFTSize(const Config& config)
+{
+    const int numBands = juce::jlimit(1, kMaxBands, config.numBands);
+    if (numBands == 1)
+        return config.fftSize;
+
+    int fftSize = config.fftSize;
+    for (int k = 1; k < numBands; ++k)
+        fftSize /= kDecimation;
+    return std::max(fftSize, kMinBandFFTSize);
+}
+
+std::vector<CurveTableLayout> MultiResolutionEngine::getCurveTableLayouts(const Config& config)
+{
+    std::vector<CurveTableLayout> layouts;
+    const int numBands = juce::jlimit(1, kMaxBands, config.numBands);
+    for (int k = 0; k < numBands; ++k)
+        layouts.push_back(SpectralEngine::getCurveTableLayout(getBandConfig(config, k)));
+    return layouts;
+}
+
+void MultiResolutionEngine::prepareBanks(const std::array<Bank, 4>& banks)
+{
+    for (auto& level : levels)
+        level.engine->prepareBanks(banks);
+}
+
+std::unique_ptr<MultiResolutionEngine::DelayLineSet> MultiResolutionEngine::createDelayLines(const Config& config,
+                                                                                          const std::array<Bank, 4>& banks)
+{
+    auto lines = std::make_unique<DelayLineSet>();
+    lines->config = config;
+    const int numBands = juce::jlimit(1, kMaxBands, config.numBands);
+    for (int k = 0; k < numBands; ++k)
+        lines->bands.push_back(SpectralEngine::createDelayLines(getBandConfig(config, k), banks));
+    return lines;
+}
+
+bool MultiResolutionEngine::takeOverDelayLines(DelayLineSet& lines)
+{
+    auto linesConfig = lines.config;
+    linesConfig.maxDelaySamples = config.maxDelaySamples;
+    if (linesConfig != config || lines.bands.size() != levels.size())
+        return false;
+
+    for (size_t k = 0; k < levels.size(); ++k)
+        levels[k].engine->takeOverDelayLines(lines.bands[k]);
+    config.maxDelaySamples = lines.config.maxDelaySamples;
+    return true;
+}
+
+bool MultiResolutionEngine::isReadingPreviousDelayLines() const
+{
+    for (auto& level : levels)
+        if (level.engine->isReadingPreviousDelayLines())
+            return true;
+    return false;
+}
+
+bool MultiResolutionEngine::hasDecayed() const
+{
+    for (auto& level : levels)
+        if (!level.engine->hasDecayed())
+            return false;
+    return true;
+}
+
+double MultiResolutionEngine::getEchoTailSeconds(const Config& config, const std::array<Bank, 4>& banks)
+{
+    double longest = 0.0;
+    const int numBands = juce::jlimit(1, kMaxBands, config.numBands);
+    for (int k = 0; k < numBands; ++k)
+        longest = std::max(longest, SpectralEngine::getEchoTailSeconds(getBandConfig(config, k), banks));
+    return longest;
+}
+
+void MultiResolutionEngine::process(const float* const* input, float* const* wet, int numSamples, bool isPrimary)
+{
+    if (levels.size() == 1)
+    {
+        levels[0].engine->process(input, wet, numSamples, isPrimary);
+        return;
+    }
+
+    std::array<const float*, SpectralEngine::kMaxChannels> chunkInput {};
+    ChannelPointers chunkWet {};
+    for (int start = 0; start < numSamples; start += kChunkSize)
+    {
+        int n = std::min(kChunkSize, numSamples - start);
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            chunkInput[static_cast<size_t>(channel)] = input[channel] + start;
+            chunkWet[static_cast<size_t>(channel)] = wet[channel] + start;
+        }
+        processLevel(0, chunkInput.data(), chunkWet.data(), n, isPrimary);
+    }
+}
+
+void MultiResolutionEngine::processLevel(size_t index, const float* const* input, float* const* output,
+                                         int numSamples, bool isPrimary)
+{
+    auto& level = levels[index];
+
+    if (index + 1 == levels.size())
+    {
+        level.engine->process(input, output, numSamples, false);
+        return;
+    }
+
+    const float* taps = filterTaps.data();
+    ChannelPointers band {}, bandOut {}, lowIn {}, lowOut {};
+    for (size_t channel = 0; channel < static_cast<size_t>(numChannels); ++channel)
+    {
+        band[channel] = level.band[channel].data();
+        bandOut[channel] = level.bandOut[channel].data();
+        lowIn[channel] = level.lowIn[channel].data();
+        lowOut[channel] = level.lowOut[channel].data();
+    }
+
+    // Decimate into the next level's input (one sample on each phase 0)
+    int numLow = 0;
+    int phase = level.phase;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        level.decimator.push(input, i);
+        if (phase == 0)
+            level.decimator.output(taps, lowIn.data(), numLow++);
+        phase = (phase + 1) % kDecimation;
+    }
+
+    processLevel(index + 1, lowIn.data(), lowOut.data(), numLow, false);
+
+    // This band: delayed input minus the interpolated low band
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        level.splitDelay.write(channel, level.splitDelayPos, input[channel], numSamples);
+        level.splitDelay.read(channel, level.splitDelayPos - (kFilterTaps - 1), band[static_cast<size_t>(channel)], numSamples);
+    }
+    level.splitDelayPos = level.splitDelay.wrap(level.splitDelayPos + numSamples);
+
+    std::array<float, SpectralEngine::kMaxChannels> interpolated {};
+    phase = level.phase;
+    for (int i = 0, low = 0; i < numSamples; ++i)
+    {
+        if (phase == 0)
+            level.splitInterpolator.push(lowIn.data(), low++);
+        level.splitInterpolator.output(taps, phase, interpolated.data());
+        for (size_t channel = 0; channel < static_cast<size_t>(numChannels); ++channel)
+            band[channel][i] -= interpolated[channel];
+        phase = (phase + 1) % kDecimation;
+    }
+
+    level.engine->process(band.data(), bandOut.data(), numSamples, isPrimary);
+
+    // Output: this band delayed to meet the lower levels, plus their interpolated output
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        level.alignDelay.write(channel, level.alignDelayPos, bandOut[static_cast<size_t>(channel)], numSamples);
+        level.alignDelay.read(channel, level.alignDelayPos - level.alignDelaySamples, output[channel], numSamples);
+    }
+    level.alignDelayPos = level.alignDelay.wrap(level.alignDelayPos + numSamples);
+
+    phase = level.phase;
+    for (int i = 0, low = 0; i < numSamples; ++i)
+    {
+        if (phase == 0)
+            level.outputInterpolator.push(lowOut.data(), low++);
+        level.outputInterpolator.output(taps, phase, interpolated.data());
+        for (size_t channel = 0; channel < static_cast<size_t>(numChannels); ++channel)
+            output[channel][i] += interpolated[channel];
+        phase = (phase + 1) % kDecimation;
+    }
+
+    level.phase = phase;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "RingBuffer.h"
+#include "SpectralEngine.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+// The processor's engine: a single SpectralEngine, or (numBands > 1) a band split
+// where each band runs its own STFT at a different sample rate.
+//
+// The split is a Laplacian pyramid: each level decimates by kDecimation, and the
+// band left at the higher rate is the input minus the re-interpolated low band.
+// Band 0 therefore holds the highs at the host rate and the last band the lows
+// at host rate / 4 (or / 16). Every band runs the same, smaller FFT (fftSize / 4,
+// or / 16, see getBandFFTSize): the lows still get the configured size's bins and
+// window length, and each band above gets 4x shorter windows, so the highs react
+// faster while the latency stays close to single-band mode (plus the filters).
+// Outputs are interpolated back up and summed with the bands time-aligned, which
+// reconstructs the input exactly when the curves are neutral, whatever the filter
+// quality.
+//
+// Every band evaluates the same bank curves on the same frequency axis (the host
+// rate's), so a curve means the same thing in every band.
+class MultiResolutionEngine
+{
+public:
+    using Config = SpectralEngine::Config;
+
+    static constexpr int kDecimation = 4;
+    static constexpr int kMaxBands = 3;
+    static constexpr int kMinBandFFTSize = 64;
+
+    MultiResolutionEngine(SpectrasaurusAudioProcessor& owner, const Config& config);
+
+    const Config& getConfig() const { return config; }
+    int getLatencySamples() const { return latencySamples; }
+
+    // Samples from the first input until every band's overlap-add is complete
+    int getWarmupSamples() const { return warmupSamples; }
+
+    // The configuration band `band` of an engine built from config runs at
+    static Config getBandConfig(const Config& config, int band);
+
+    // FFT size every band of a split runs: fftSize / kDecimation per extra band,
+    // at least kMinBandFFTSize (then the lows' windows get longer than fftSize)
+    static int getBandFFTSize(const Config& config);
+
+    // Curve table layouts of every band, so bank snapshots can be compiled for them
+    static std::vector<CurveTableLayout> getCurveTableLayouts(const Config& config);
+
+    void prepareBanks(const std::array<Bank, 4>& banks);
+
+    // Same contract as SpectralEngine::process. The spectrograph comes from band 0.
+    void process(const float* const* input, float* const* wet, int numSamples, bool isPrimary);
+
+    // Every band's delay lines, for an engine built from config
+    struct DelayLineSet
+    {
+        Config config;
+        std::vector<std::unique_ptr<SpectralEngine::DelayLines>> bands;
+    };
+
+    // Not real-time safe; any thread
+    static std::unique_ptr<DelayLineSet> createDelayLines(const Config& config, const std::array<Bank, 4>& banks);
+
+    // Audio thread, between blocks: move every band onto lines, if they were made
+    // for this engine's configuration (the delay capacity may differ). lines then
+    // holds the replaced ones, which stay in use until isReadingPreviousDelayLines()
+    // is false (see SpectralEngine::takeOverDelayLines).
+    bool takeOverDelayLines(DelayLineSet& lines);
+    bool isReadingPreviousDelayLines() const;
+
+    // SpectralEngine::hasDecayed for every band. The band filters still need
+    // getWarmupSamples() of silence after that before the output is silent.
+    bool hasDecayed() const;
+
+    // SpectralEngine::getEchoTailSeconds over every band
+    static double getEchoTailSeconds(const Config& config, const std::array<Bank, 4>& banks);
+
+private:
+    // Linear-phase FIR lowpass shared by the decimators and interpolators
+    static constexpr int kFilterTaps = 32 * kDecimation - 1;
+    static constexpr int kChunkSize = 512;
+
+    using ChannelPointers = std::array<float*, SpectralEngine::kMaxChannels>;
+
+    // Multichannel FIR decimator: one output for every kDecimation inputs, on phase 0.
+    // push and output take one sample per channel, at index i of each channel.
+    struct Decimator
+    {
+        std::vector<std::vector<float>> history; // per channel, doubled so each dot product is contiguous
+        int pos = 0;
+
+        void reset(int numChannels);
+        void push(const float* const* input, int i);
+        void output(const float* taps, float* const* dest, int i) const;
+    };
+
+    // Multichannel zero-stuffing FIR interpolator (polyphase), consuming one
+    // low-rate sample on phase 0 and producing one output per call
+    struct Interpolator
+    {
+        static constexpr int kTapsPerPhase = (kFilterTaps + kDecimation - 1) / kDecimation;
+        std::vector<std::vector<float>> history;
+        int pos = 0;
+
+        void reset(int numChannels);
+        void push(const float* const* input, int i);
+        void output(const float* taps, int phase, float* result) const; // one value per channel
+    };
+
+    struct Level
+    {
+        std::unique_ptr<SpectralEngine> engine;
+
+        // Towards the next (lower) level; unused on the last level
+        Decimator decimator;
+        Interpolator splitInterpolator;  // rebuilds the low band to subtract it
+        Interpolator outputInterpolator; // brings the lower levels' output back up
+        RingBuffer splitDelay;           // input, delayed to line up with the subtraction
+        RingBuffer alignDelay;           // this band's output, delayed to line up with the lower levels
+        int splitDelayPos = 0;
+        int alignDelayPos = 0;
+        int alignDelaySamples = 0;
+        int phase = 0;
+
+        // Per-chunk scratch at this level's rate, per channel
+        std::vector<std::vector<float>> band, bandOut, lowIn, lowOut;
+    };
+
+    void processLevel(size_t index, const float* const* input, float* const* output, int numSamples, bool isPrimary);
+
+    Config config;
+    int numChannels = 0;
+    std::vector<Level> levels;
+    std::vector<float> filterTaps;
+    int latencySamples = 0;
+    int warmupSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiResolutionEngine)
+};
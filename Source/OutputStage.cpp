@@ -0,0 +1,60 @@
+#include "OutputStage.h"
+#include "FastMath.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+void OutputStage::prepare(const Settings& settings)
+{
+    bankClip = settings.bankClip;
+    masterClip = settings.masterClip;
+    dryWet = settings.dryWet;
+
+    const float panGains[kNumSides] = { settings.panGainL, settings.panGainR, 1.0f };
+    for (int side = 0; side < kNumSides; ++side)
+    {
+        // Gain carried along since the last tanh
+        auto& g = gains[side];
+        float gain = settings.bankGain;
+        if (bankClip)
+        {
+            // threshold * tanh(x * gain / threshold)
+            g.bankClipInput = gain / settings.bankClipThreshold;
+            gain = settings.bankClipThreshold;
+        }
+        gain *= panGains[side] * settings.masterGain;
+        if (masterClip)
+        {
+            g.masterClipInput = gain / settings.masterClipThreshold;
+            gain = settings.masterClipThreshold;
+        }
+        g.output = gain;
+    }
+}
+
+float OutputStage::process(Side side, float* wet, float* inOut, int numSamples) const
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    const auto& g = gains[side];
+    if (bankClip)
+        for (int i = 0; i < numSamples; ++i)
+            wet[i] = fastTanh(wet[i] * g.bankClipInput);
+    if (masterClip)
+        for (int i = 0; i < numSamples; ++i)
+            wet[i] = fastTanh(wet[i] * g.masterClipInput);
+
+    if (dryWet < 1.0f)
+    {
+        const float wetGain = g.output;
+        const float mix = dryWet;
+        for (int i = 0; i < numSamples; ++i)
+            inOut[i] += mix * (wet[i] * wetGain - inOut[i]);
+    }
+    else
+    {
+        juce::FloatVectorOperations::copyWithMultiply(inOut, wet, g.output, numSamples);
+    }
+
+    const auto range = juce::FloatVectorOperations::findMinAndMax(inOut, numSamples);
+    return std::max(-range.getStart(), range.getEnd());
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// What happens to the engine output on its way to the host: bank gain, bank soft
+// clip, equal-power pan, master gain, master soft clip, dry/wet and peak metering.
+//
+// The settings are fixed for a block, so prepare() folds each run of constant
+// gains into one multiply (each clip's input scaling included) and decides up
+// front which passes run. process() then makes a few straight passes over the
+// samples that the compiler can vectorize.
+class OutputStage
+{
+public:
+    struct Settings
+    {
+        float bankGain = 1.0f;
+        bool bankClip = false;
+        float bankClipThreshold = 1.0f;
+        float panGainL = 1.0f;
+        float panGainR = 1.0f;
+        float masterGain = 1.0f;
+        bool masterClip = false;
+        float masterClipThreshold = 1.0f;
+        float dryWet = 1.0f; // 0 = dry, 1 = wet
+    };
+
+    // Which pan gain a channel takes: the left or right side of a pair, or none
+    // for a lone channel on the mid settings (see SpectralEngine::ChannelPairing)
+    enum Side { Left, Right, Centre, kNumSides };
+
+    void prepare(const Settings& settings);
+
+    // Writes one channel's output over inOut, which holds the dry input on entry.
+    // wet is used as scratch. Returns the output's peak magnitude.
+    float process(Side side, float* wet, float* inOut, int numSamples) const;
+
+private:
+    struct ChannelGains
+    {
+        float bankClipInput = 1.0f;   // wet -> bank tanh argument
+        float masterClipInput = 1.0f; // -> master tanh argument
+        float output = 1.0f;          // -> output level
+    };
+
+    ChannelGains gains[kNumSides];
+    bool bankClip = false;
+    bool masterClip = false;
+    float dryWet = 1.0f;
+};
@@ -0,0 +1,85 @@
+#include "PffftBackend.h"
+#include <pffft.h>
+#include <cstring>
+
+PffftBackend::PffftBackend(int fftSize)
+    : FFTBackend(fftSize)
+{
+    complexSetup = pffft_new_setup(fftSize, PFFFT_COMPLEX);
+    realSetup = pffft_new_setup(fftSize, PFFFT_REAL);
+
+    const size_t bytes = 2 * static_cast<size_t>(fftSize) * sizeof(float);
+    alignedInput = static_cast<float*>(pffft_aligned_malloc(bytes));
+    alignedOutput = static_cast<float*>(pffft_aligned_malloc(bytes));
+    work = static_cast<float*>(pffft_aligned_malloc(bytes));
+}
+
+PffftBackend::~PffftBackend()
+{
+    pffft_aligned_free(work);
+    pffft_aligned_free(alignedOutput);
+    pffft_aligned_free(alignedInput);
+    if (realSetup != nullptr)
+        pffft_destroy_setup(realSetup);
+    if (complexSetup != nullptr)
+        pffft_destroy_setup(complexSetup);
+}
+
+bool PffftBackend::isPrepared() const
+{
+    return complexSetup != nullptr && realSetup != nullptr
+        && alignedInput != nullptr && alignedOutput != nullptr && work != nullptr;
+}
+
+bool PffftBackend::supportsSize(int size)
+{
+    // The SIMD real transform works on four interleaved quarter-length vectors,
+    // hence the multiple of 32 (of 16 for complex)
+    if (size < 32 || size % 32 != 0)
+        return false;
+
+    for (int factor : { 2, 3, 5 })
+        while (size % factor == 0)
+            size /= factor;
+    return size == 1;
+}
+
+void PffftBackend::perform(const Complex* in, Complex* out, bool inverse)
+{
+    const size_t bytes = 2 * static_cast<size_t>(size) * sizeof(float);
+    std::memcpy(alignedInput, reinterpret_cast<const float*>(in), bytes);
+    pffft_transform_ordered(complexSetup, alignedInput, alignedOutput, work,
+                            inverse ? PFFFT_BACKWARD : PFFFT_FORWARD);
+
+    if (inverse)
+        juce::FloatVectorOperations::multiply(alignedOutput, 1.0f / static_cast<float>(size), 2 * size);
+    std::memcpy(reinterpret_cast<float*>(out), alignedOutput, bytes);
+}
+
+void PffftBackend::performRealOnlyForwardTransform(float* data)
+{
+    std::memcpy(alignedInput, data, static_cast<size_t>(size) * sizeof(float));
+    pffft_transform_ordered(realSetup, alignedInput, alignedOutput, work, PFFFT_FORWARD);
+
+    // PFFFT packs the real Nyquist bin into DC's imaginary slot:
+    // [ re(0), re(N/2), re(1), im(1), ..., re(N/2 - 1), im(N/2 - 1) ]
+    const int half = size / 2;
+    std::memcpy(data + 2, alignedOutput + 2, static_cast<size_t>(size - 2) * sizeof(float));
+    data[0] = alignedOutput[0];
+    data[1] = 0.0f;
+    data[2 * half] = alignedOutput[1];
+    data[2 * half + 1] = 0.0f;
+}
+
+void PffftBackend::performRealOnlyInverseTransform(float* data)
+{
+    // Bins 0..N/2 in, in PFFFT's packing (the DC and Nyquist imaginary parts
+    // can't reach a real output, so they're dropped)
+    const int half = size / 2;
+    alignedInput[0] = data[0];
+    alignedInput[1] = data[2 * half];
+    std::memcpy(alignedInput + 2, data + 2, static_cast<size_t>(size - 2) * sizeof(float));
+    pffft_transform_ordered(realSetup, alignedInput, alignedOutput, work, PFFFT_BACKWARD);
+
+    juce::FloatVectorOperations::multiply(data, alignedOutput, 1.0f / static_cast<float>(size), size);
+}
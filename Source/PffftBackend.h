@@ -0,0 +1,37 @@
+#pragma once
+
+#include "FFTBackend.h"
+
+struct PFFFT_Setup;
+
+// PFFFT (https://bitbucket.org/jpommier/pffft): SIMD complex and real transforms,
+// SSE on x86 and NEON on ARM. Sizes must be multiples of 32 with no prime factors
+// other than 2, 3 and 5, which covers every size the plugin offers. Only built with
+// SPECTRASAURUS_WITH_PFFFT (see CMakeLists.txt).
+class PffftBackend : public FFTBackend
+{
+public:
+    explicit PffftBackend(int fftSize);
+    ~PffftBackend() override;
+
+    const char* getName() const override { return "PFFFT"; }
+    void perform(const Complex* in, Complex* out, bool inverse) override;
+    void performRealOnlyForwardTransform(float* data) override;
+    void performRealOnlyInverseTransform(float* data) override;
+
+    static bool supportsSize(int size);
+
+    // False if PFFFT turned the size down or an aligned buffer couldn't be had
+    bool isPrepared() const;
+
+private:
+    PFFFT_Setup* complexSetup = nullptr;
+    PFFFT_Setup* realSetup = nullptr;
+
+    // PFFFT wants SIMD-aligned buffers, so data goes through these (2 * size floats each)
+    float* alignedInput = nullptr;
+    float* alignedOutput = nullptr;
+    float* work = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (PffftBackend)
+};
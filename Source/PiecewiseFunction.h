@@ -12,6 +12,7 @@ struct ControlPoint
     ControlPoint(float x_ = 0.0f, float y_ = 0.0f) : x(x_), y(y_) {}
 
     bool operator<(const ControlPoint& other) const { return x < other.x; }
+    bool operator==(const ControlPoint& other) const { return x == other.x && y == other.y; }
 };
 
 class PiecewiseFunction
@@ -56,11 +57,15 @@ public:
     // Copy from another function
     void copyFrom(const PiecewiseFunction& other);
 
+    // Same control points (the version is not compared)
+    bool operator==(const PiecewiseFunction& other) const { return points == other.points; }
+    bool operator!=(const PiecewiseFunction& other) const { return !(*this == other); }
+
     // Serialization
     juce::var toVar() const;
     void fromVar(const juce::var& v);
 
-    // Version counter — incremented on every mutation for LUT cache invalidation
+    // Version counter — incremented on every mutation
     uint32_t version = 0;
 
 private:
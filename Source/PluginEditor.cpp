@@ -78,6 +78,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     shiftL.setClipboard(&curveClipboard, &clipboardFilled, &clipboardMeta);
     shiftL.onSettingsChanged = [this] {
         // Only order button affects audio — ranges are display-only
+        audioProcessor.publishBanksIfChanged();
     };
     addAndMakeVisible(shiftL);
 
@@ -85,6 +86,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     shiftR.setClipboard(&curveClipboard, &clipboardFilled, &clipboardMeta);
     shiftR.onSettingsChanged = [this] {
         // Only order button affects audio — ranges are display-only
+        audioProcessor.publishBanksIfChanged();
     };
     addAndMakeVisible(shiftR);
 
@@ -142,6 +144,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     gainSlider.onValueChange = [this]()
     {
         audioProcessor.banks[selectedBank].gainDB = static_cast<float>(gainSlider.getValue());
+        audioProcessor.publishBanks();
     };
     addAndMakeVisible(gainSlider);
 
@@ -159,6 +162,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     softClipSlider.onValueChange = [this]()
     {
         audioProcessor.banks[selectedBank].softClipThresholdDB = static_cast<float>(softClipSlider.getValue());
+        audioProcessor.publishBanks();
     };
     addAndMakeVisible(softClipSlider);
 
@@ -176,6 +180,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     panSlider.onValueChange = [this]()
     {
         audioProcessor.banks[selectedBank].panValue = static_cast<float>(panSlider.getValue());
+        audioProcessor.publishBanks();
     };
     addAndMakeVisible(panSlider);
 
@@ -236,6 +241,55 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     masterDryWetLabel.setFont(11.0f);
     addAndMakeVisible(masterDryWetLabel);
 
+    // Setup FFT size / overlap / window / band selectors (global, applied by a background engine swap)
+    for (int size : SpectrasaurusAudioProcessor::getAvailableFFTSizes())
+        fftSizeBox.addItem(juce::String(size), size);
+    for (int overlap : SpectrasaurusAudioProcessor::getAvailableOverlapFactors())
+        overlapBox.addItem(juce::String(overlap) + "x", overlap);
+    auto windowNames = STFTWindowPair::getWindowNames();
+    for (int i = 0; i < windowNames.size(); ++i)
+        windowBox.addItem(windowNames[i], i + 1);
+    bandsBox.addItem("Single", 1);
+    for (int bands = 2; bands <= MultiResolutionEngine::kMaxBands; ++bands)
+        bandsBox.addItem(juce::String(bands) + " bands", bands);
+    auto applyFFTSettings = [this]()
+    {
+        SpectrasaurusAudioProcessor::FFTSettings settings;
+        settings.fftSize = fftSizeBox.getSelectedId();
+        settings.overlapFactor = overlapBox.getSelectedId();
+        settings.window = static_cast<STFTWindow>(windowBox.getSelectedId() - 1);
+        settings.numBands = bandsBox.getSelectedId();
+        audioProcessor.setFFTSettings(settings);
+    };
+    fftSizeBox.onChange = applyFFTSettings;
+    overlapBox.onChange = applyFFTSettings;
+    windowBox.onChange = applyFFTSettings;
+    bandsBox.onChange = applyFFTSettings;
+    addAndMakeVisible(fftSizeBox);
+    addAndMakeVisible(overlapBox);
+    addAndMakeVisible(windowBox);
+    addAndMakeVisible(bandsBox);
+
+    fftSizeLabel.setText("FFT", juce::dontSendNotification);
+    fftSizeLabel.setJustificationType(juce::Justification::centredRight);
+    fftSizeLabel.setFont(11.0f);
+    addAndMakeVisible(fftSizeLabel);
+
+    overlapLabel.setText("Overlap", juce::dontSendNotification);
+    overlapLabel.setJustificationType(juce::Justification::centredRight);
+    overlapLabel.setFont(11.0f);
+    addAndMakeVisible(overlapLabel);
+
+    windowLabel.setText("Window", juce::dontSendNotification);
+    windowLabel.setJustificationType(juce::Justification::centredRight);
+    windowLabel.setFont(11.0f);
+    addAndMakeVisible(windowLabel);
+
+    bandsLabel.setText("Bands", juce::dontSendNotification);
+    bandsLabel.setJustificationType(juce::Justification::centredRight);
+    bandsLabel.setFont(11.0f);
+    addAndMakeVisible(bandsLabel);
+
     // Setup preset save/load buttons
     savePresetButton.setButtonText("Save");
     savePresetButton.onClick = [this] { savePreset(); };
@@ -290,6 +344,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
             val = juce::jlimit(1.0f, 99000.0f, val);
             editor.setText(juce::String(val, 0), false);
             setter(val);
+            audioProcessor.publishBanks();
             audioProcessor.reallocateDelayBuffersIfNeeded();
             updateSnapWindows();
         };
@@ -299,6 +354,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
             val = juce::jlimit(1.0f, 99000.0f, val);
             editor.setText(juce::String(val, 0), false);
             setter(val);
+            audioProcessor.publishBanks();
             audioProcessor.reallocateDelayBuffersIfNeeded();
             updateSnapWindows();
         };
@@ -320,6 +376,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
         {
             bool logScale = btn.getToggleState();
             setter(logScale);
+            audioProcessor.publishBanks();
             btn.setButtonText(logScale ? "Log" : "Linear");
             updateSnapWindows();
         };
@@ -337,6 +394,7 @@ SpectrasaurusAudioProcessorEditor::SpectrasaurusAudioProcessorEditor (Spectrasau
     masterGainSlider.setValue(audioProcessor.masterGainDB.load(), juce::dontSendNotification);
     masterClipSlider.setValue(audioProcessor.masterClipDB.load(), juce::dontSendNotification);
     masterDryWetSlider.setValue(audioProcessor.masterDryWet.load() * 100.0, juce::dontSendNotification);
+    syncFFTSettingsBoxes();
 
     // Restore notes text
     notesEditor.setText(audioProcessor.notesText, false);
@@ -395,6 +453,9 @@ SpectrasaurusAudioProcessorEditor::~SpectrasaurusAudioProcessorEditor()
 
 void SpectrasaurusAudioProcessorEditor::timerCallback()
 {
+    // Snap windows edit the bank curves in place; hand any changes to the audio thread
+    audioProcessor.publishBanksIfChanged();
+
     // Update meter levels from processor
     meterLevelL = audioProcessor.outputLevelL.load();
     meterLevelR = audioProcessor.outputLevelR.load();
@@ -416,6 +477,15 @@ void SpectrasaurusAudioProcessorEditor::timerCallback()
     dynamicsR.repaint();
 }
 
+void SpectrasaurusAudioProcessorEditor::syncFFTSettingsBoxes()
+{
+    auto settings = audioProcessor.getFFTSettings();
+    fftSizeBox.setSelectedId(settings.fftSize, juce::dontSendNotification);
+    overlapBox.setSelectedId(settings.overlapFactor, juce::dontSendNotification);
+    windowBox.setSelectedId(static_cast<int>(settings.window) + 1, juce::dontSendNotification);
+    bandsBox.setSelectedId(settings.numBands, juce::dontSendNotification);
+}
+
 void SpectrasaurusAudioProcessorEditor::selectBank(int bankIndex)
 {
     selectedBank = bankIndex;
@@ -505,10 +575,7 @@ void SpectrasaurusAudioProcessorEditor::showBankContextMenu(int bankIndex)
         if (result == 1)
         {
             // Copy Bank (curves + view state)
-            {
-                juce::SpinLock::ScopedLockType lock(self->audioProcessor.bankLock);
-                self->bankClipboard = bank;
-            }
+            self->bankClipboard = bank;
             // Capture view state (which curve is shown + zoom ranges)
             auto& vs = self->bankViewClipboard;
             vs.dynamicsLCurveIndex = self->dynamicsL.getActiveCurve();
@@ -529,10 +596,8 @@ void SpectrasaurusAudioProcessorEditor::showBankContextMenu(int bankIndex)
         else if (result == 2 && self->bankClipboardFilled)
         {
             // Paste Bank (curves + view state)
-            {
-                juce::SpinLock::ScopedLockType lock(self->audioProcessor.bankLock);
-                bank = self->bankClipboard;
-            }
+            bank = self->bankClipboard;
+            self->audioProcessor.publishBanks();
             // Restore view state
             auto& vs = self->bankViewClipboard;
             self->dynamicsL.setActiveCurve(vs.dynamicsLCurveIndex);
@@ -558,19 +623,17 @@ void SpectrasaurusAudioProcessorEditor::showBankContextMenu(int bankIndex)
         else if (result == 3)
         {
             // Copy L -> R (curves + settings + view state)
-            {
-                juce::SpinLock::ScopedLockType lock(self->audioProcessor.bankLock);
-                bank.delayR.copyFrom(bank.delayL);
-                bank.panR.copyFrom(bank.panL);
-                bank.feedbackR.copyFrom(bank.feedbackL);
-                bank.preGainR.copyFrom(bank.preGainL);
-                bank.minGateR.copyFrom(bank.minGateL);
-                bank.maxClipR.copyFrom(bank.maxClipL);
-                bank.shiftR.copyFrom(bank.shiftL);
-                bank.multiplyR.copyFrom(bank.multiplyL);
-                bank.delayMaxTimeMsR = bank.delayMaxTimeMsL;
-                bank.delayLogScaleR = bank.delayLogScaleL;
-            }
+            bank.delayR.copyFrom(bank.delayL);
+            bank.panR.copyFrom(bank.panL);
+            bank.feedbackR.copyFrom(bank.feedbackL);
+            bank.preGainR.copyFrom(bank.preGainL);
+            bank.minGateR.copyFrom(bank.minGateL);
+            bank.maxClipR.copyFrom(bank.maxClipL);
+            bank.shiftR.copyFrom(bank.shiftL);
+            bank.multiplyR.copyFrom(bank.multiplyL);
+            bank.delayMaxTimeMsR = bank.delayMaxTimeMsL;
+            bank.delayLogScaleR = bank.delayLogScaleL;
+            self->audioProcessor.publishBanks();
 
             // Copy view state L -> R
             self->dynamicsR.setActiveCurve(self->dynamicsL.getActiveCurve());
@@ -588,19 +651,17 @@ void SpectrasaurusAudioProcessorEditor::showBankContextMenu(int bankIndex)
         else if (result == 4)
         {
             // Copy R -> L (curves + settings + view state)
-            {
-                juce::SpinLock::ScopedLockType lock(self->audioProcessor.bankLock);
-                bank.delayL.copyFrom(bank.delayR);
-                bank.panL.copyFrom(bank.panR);
-                bank.feedbackL.copyFrom(bank.feedbackR);
-                bank.preGainL.copyFrom(bank.preGainR);
-                bank.minGateL.copyFrom(bank.minGateR);
-                bank.maxClipL.copyFrom(bank.maxClipR);
-                bank.shiftL.copyFrom(bank.shiftR);
-                bank.multiplyL.copyFrom(bank.multiplyR);
-                bank.delayMaxTimeMsL = bank.delayMaxTimeMsR;
-                bank.delayLogScaleL = bank.delayLogScaleR;
-            }
+            bank.delayL.copyFrom(bank.delayR);
+            bank.panL.copyFrom(bank.panR);
+            bank.feedbackL.copyFrom(bank.feedbackR);
+            bank.preGainL.copyFrom(bank.preGainR);
+            bank.minGateL.copyFrom(bank.minGateR);
+            bank.maxClipL.copyFrom(bank.maxClipR);
+            bank.shiftL.copyFrom(bank.shiftR);
+            bank.multiplyL.copyFrom(bank.multiplyR);
+            bank.delayMaxTimeMsL = bank.delayMaxTimeMsR;
+            bank.delayLogScaleL = bank.delayLogScaleR;
+            self->audioProcessor.publishBanks();
 
             // Copy view state R -> L
             self->dynamicsL.setActiveCurve(self->dynamicsR.getActiveCurve());
@@ -617,11 +678,9 @@ void SpectrasaurusAudioProcessorEditor::showBankContextMenu(int bankIndex)
         }
         else if (result == 5)
         {
-            // Reset Bank (under lock)
-            {
-                juce::SpinLock::ScopedLockType lock(self->audioProcessor.bankLock);
-                bank.reset();
-            }
+            // Reset Bank
+            bank.reset();
+            self->audioProcessor.publishBanks();
             if (bankIndex == self->selectedBank)
                 self->updateSnapWindows();
         }
@@ -653,6 +712,11 @@ void SpectrasaurusAudioProcessorEditor::savePreset()
             root->setProperty("masterGainDB", static_cast<double>(audioProcessor.masterGainDB.load()));
             root->setProperty("masterClipDB", static_cast<double>(audioProcessor.masterClipDB.load()));
             root->setProperty("masterDryWet", static_cast<double>(audioProcessor.masterDryWet.load()));
+            auto fftSettings = audioProcessor.getFFTSettings();
+            root->setProperty("fftSize", fftSettings.fftSize);
+            root->setProperty("overlapFactor", fftSettings.overlapFactor);
+            root->setProperty("fftWindow", static_cast<int>(fftSettings.window));
+            root->setProperty("fftBands", fftSettings.numBands);
 
             // Dropdown selections
             root->setProperty("dynamicsLCurveIndex", dynamicsL.getActiveCurve());
@@ -717,10 +781,10 @@ void SpectrasaurusAudioProcessorEditor::loadPreset()
                 auto banksVar = root->getProperty("banks");
                 if (auto* banksArray = banksVar.getArray())
                 {
-                    juce::SpinLock::ScopedLockType lock(audioProcessor.bankLock);
                     int count = std::min(static_cast<int>(banksArray->size()), 4);
                     for (int i = 0; i < count; ++i)
                         audioProcessor.banks[i].fromVar((*banksArray)[i]);
+                    audioProcessor.publishBanks();
                 }
 
                 // Restore master controls
@@ -743,6 +807,19 @@ void SpectrasaurusAudioProcessorEditor::loadPreset()
                     masterDryWetSlider.setValue(dw * 100.0, juce::dontSendNotification);
                 }
 
+                // Restore FFT settings (older presets keep the current ones)
+                auto fftSettings = audioProcessor.getFFTSettings();
+                if (root->hasProperty("fftSize"))
+                    fftSettings.fftSize = static_cast<int>(root->getProperty("fftSize"));
+                if (root->hasProperty("overlapFactor"))
+                    fftSettings.overlapFactor = static_cast<int>(root->getProperty("overlapFactor"));
+                if (root->hasProperty("fftWindow"))
+                    fftSettings.window = static_cast<STFTWindow>(static_cast<int>(root->getProperty("fftWindow")));
+                if (root->hasProperty("fftBands"))
+                    fftSettings.numBands = static_cast<int>(root->getProperty("fftBands"));
+                audioProcessor.setFFTSettings(fftSettings);
+                syncFFTSettingsBoxes();
+
                 // Restore notes
                 if (root->hasProperty("notesText"))
                 {
@@ -1116,6 +1193,26 @@ void SpectrasaurusAudioProcessorEditor::resized()
         auto inner = masterPanel.reduced(panelPad);
         inner.removeFromTop(panelTitleH); // space for title
 
+        // FFT size / overlap and window / bands rows along the top
+        auto fftRow = inner.removeFromTop(22);
+        int fftHalf = fftRow.getWidth() / 2;
+        auto fftSizeArea = fftRow.removeFromLeft(fftHalf).reduced(2, 0);
+        fftSizeLabel.setBounds(fftSizeArea.removeFromLeft(32));
+        fftSizeBox.setBounds(fftSizeArea);
+        auto overlapArea = fftRow.reduced(2, 0);
+        overlapLabel.setBounds(overlapArea.removeFromLeft(50));
+        overlapBox.setBounds(overlapArea);
+        inner.removeFromTop(2);
+
+        auto windowRow = inner.removeFromTop(22);
+        auto windowArea = windowRow.removeFromLeft(windowRow.getWidth() * 3 / 5).reduced(2, 0);
+        windowLabel.setBounds(windowArea.removeFromLeft(50));
+        windowBox.setBounds(windowArea);
+        auto bandsArea = windowRow.reduced(2, 0);
+        bandsLabel.setBounds(bandsArea.removeFromLeft(40));
+        bandsBox.setBounds(bandsArea);
+        inner.removeFromTop(2);
+
         // Level meters — fill most of the vertical space, leave room for knobs
         int knobH = 75;
         auto meterArea = inner.removeFromTop(inner.getHeight() - knobH);
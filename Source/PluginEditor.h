@@ -76,6 +76,18 @@ private:
     juce::Slider masterDryWetSlider;
     juce::Label masterDryWetLabel;
 
+    // FFT size / overlap / window / band selectors (global; size, overlap and band
+    // item IDs are the values themselves, window IDs are STFTWindow + 1)
+    juce::ComboBox fftSizeBox;
+    juce::Label fftSizeLabel;
+    juce::ComboBox overlapBox;
+    juce::Label overlapLabel;
+    juce::ComboBox windowBox;
+    juce::Label windowLabel;
+    juce::ComboBox bandsBox;
+    juce::Label bandsLabel;
+    void syncFFTSettingsBoxes();
+
     // Delay max time editors (per channel)
     juce::Label delayMaxCaptionL;
     juce::TextEditor delayMaxEditorL;
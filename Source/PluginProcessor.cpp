@@ -1,8 +1,72 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "DebugLogger.h"
-#include <complex>
-#include <cstring>
+
+namespace
+{
+// Options for the process-wide frame worker pool, if this instance is the one that
+// creates it: one worker per physical core bar one, unless overridden by the
+// SPECTRASAURUS_FRAME_WORKERS environment variable (0 disables them).
+// SPECTRASAURUS_FRAME_WORKERS_FIFO=1 and SPECTRASAURUS_FRAME_WORKERS_PIN=1 ask for
+// SCHED_FIFO and one CPU per worker on Linux.
+FrameWorkerPool::Options getFrameWorkerOptions()
+{
+    FrameWorkerPool::Options options;
+
+    auto workers = juce::SystemStats::getEnvironmentVariable("SPECTRASAURUS_FRAME_WORKERS", {});
+    if (workers.isNotEmpty())
+        options.numWorkers = juce::jlimit(0, 64, workers.getIntValue());
+    else
+        options.numWorkers = juce::jlimit(0, 64, juce::SystemStats::getNumPhysicalCpus() - 1);
+
+    // SCHED_FIFO workers preempt everything below them, including the host's GUI and
+    // disk threads. Between jobs each one still polls for up to about 128 pauses
+    // (a few microseconds, yielding every 16) before it sleeps, so with many busy
+    // instances the cores they run on are mostly unavailable to other threads.
+    // Off by default; only worth it on a tuned real-time system.
+    options.fifoPriority = juce::SystemStats::getEnvironmentVariable("SPECTRASAURUS_FRAME_WORKERS_FIFO", {}) == "1";
+    options.pinToCores = juce::SystemStats::getEnvironmentVariable("SPECTRASAURUS_FRAME_WORKERS_PIN", {}) == "1";
+    return options;
+}
+
+// Threads that help the builder compile curve tables, besides itself
+int getNumCurveCompileThreads()
+{
+    return juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1);
+}
+} // namespace
+
+// Builds replacement engines and compiles bank snapshots off the audio thread, and
+// frees retired engines and bank snapshots
+class SpectrasaurusAudioProcessor::EngineBuildThread : public juce::Thread
+{
+public:
+    explicit EngineBuildThread(SpectrasaurusAudioProcessor& p)
+        : juce::Thread("Spectrasaurus engine builder"), processor(p) {}
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(100);
+
+            delete processor.retiredEngine.exchange(nullptr);
+            delete processor.retiredBankSnapshot.exchange(nullptr);
+            delete processor.retiredDelayLines.exchange(nullptr);
+
+            const juce::ScopedLock sl(processor.builderLock);
+            processor.compileQueuedBanks();
+
+            if (processor.engineRebuildRequested.exchange(false))
+                processor.buildPendingEngine();
+            if (processor.delayResizeRequested.exchange(false))
+                processor.buildPendingDelayLines();
+        }
+    }
+
+private:
+    SpectrasaurusAudioProcessor& processor;
+};
 
 SpectrasaurusAudioProcessor::SpectrasaurusAudioProcessor()
      : AudioProcessor (BusesProperties()
@@ -20,12 +84,47 @@ SpectrasaurusAudioProcessor::SpectrasaurusAudioProcessor()
                           "Morph Y",
                           juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f),
                           0.0f)
-                  })
+                  }),
+       frameWorkers(FrameWorkerPool::getShared(getFrameWorkerOptions())),
+       curveCompilePool(getNumCurveCompileThreads(), 0, juce::Thread::Priority::low)
 {
+    // Optional kernel override for A/B testing the SIMD paths
+    auto isaName = juce::SystemStats::getEnvironmentVariable("SPECTRASAURUS_KERNEL_ISA", {}).toLowerCase();
+    if (isaName == "scalar")       forcedKernelIsa = KernelIsa::Scalar;
+    else if (isaName == "sse2")    forcedKernelIsa = KernelIsa::SSE2;
+    else if (isaName == "avx2")    forcedKernelIsa = KernelIsa::AVX2;
+    else if (isaName == "avx512")  forcedKernelIsa = KernelIsa::AVX512;
+
+    DEBUG_LOG("Spectral kernels: ", SpectralKernels::get(forcedKernelIsa.load()).name);
+
+    auto delayPrecision = juce::SystemStats::getEnvironmentVariable("SPECTRASAURUS_DELAY_PRECISION", {}).toLowerCase();
+    engineConfig.halfPrecisionDelays = (delayPrecision == "half");
+
+    publishedBanks = banks;
+    compiledBanks = banks;
+    activeBankSnapshot = new BankSnapshot { banks, {} };
+    activeBankSnapshot.load()->activeStages = BankSnapshot::findActiveStages(banks);
+
+    engineBuilder = std::make_unique<EngineBuildThread>(*this);
+    engineBuilder->startThread();
+
+    startTimerHz(20);
 }
 
 SpectrasaurusAudioProcessor::~SpectrasaurusAudioProcessor()
 {
+    stopTimer();
+    engineBuilder->stopThread(2000);
+
+    delete pendingEngine.exchange(nullptr);
+    delete retiredEngine.exchange(nullptr);
+    delete pendingDelayLines.exchange(nullptr);
+    delete retiredDelayLines.exchange(nullptr);
+
+    delete queuedBankSnapshot.exchange(nullptr);
+    delete pendingBankSnapshot.exchange(nullptr);
+    delete activeBankSnapshot.exchange(nullptr);
+    delete retiredBankSnapshot.exchange(nullptr);
 }
 
 const juce::String SpectrasaurusAudioProcessor::getName() const
@@ -50,7 +149,10 @@ bool SpectrasaurusAudioProcessor::isMidiEffect() const
 
 double SpectrasaurusAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const double sampleRate = getSampleRate();
+    if (sampleRate <= 0.0)
+        return 0.0;
+    return engineWarmupSamples.load() / sampleRate + echoTailSeconds.load();
 }
 
 int SpectrasaurusAudioProcessor::getNumPrograms()
@@ -82,9 +184,65 @@ void SpectrasaurusAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     DEBUG_LOG("Sample rate: ", sampleRate);
     DEBUG_LOG("Samples per block: ", samplesPerBlock);
 
-    currentSampleRate = sampleRate;
-    currentFFTSize = banks[0].fftSize;
-    currentOverlapFactor = banks[0].overlapFactor;
+    MultiResolutionEngine::Config config;
+    {
+        // Keeps the FFT settings already in engineConfig
+        const juce::ScopedLock sl(engineConfigLock);
+        config = engineConfig;
+    }
+    config.sampleRate = sampleRate;
+    config.maxDelaySamples = computeMaxDelaySamples(sampleRate);
+    SpectralEngine::pairChannels(config, getChannelLayoutOfBus(true, 0));
+
+    DEBUG_LOG("FFT size: ", config.fftSize);
+    DEBUG_LOG("Overlap factor: ", config.overlapFactor);
+    DEBUG_LOG("Max delay samples: ", config.maxDelaySamples);
+    DEBUG_LOG("Channels: ", config.numChannels, " in ", config.numPairs, " pairs");
+
+    {
+        const juce::ScopedLock sl(engineConfigLock);
+        engineConfig = config;
+        publishedConfig = config;
+        engineRebuildRequested = false;
+    }
+
+    // The engine's delay lines are sized for the banks it's built with, so compile
+    // the last ones published (e.g. by setStateInformation) right here, with tables
+    // for the new configuration. Holding builderLock keeps engineBuilder out until
+    // it's done; the retired snapshot is freed first so the new one can go live.
+    {
+        const juce::ScopedLock sl(builderLock);
+        bankRecompileRequested = true;
+        compileQueuedBanks();
+        delete retiredBankSnapshot.exchange(nullptr);
+    }
+
+    // Nothing is processing yet, so the engine is built right here
+    delete pendingEngine.exchange(nullptr);
+    fadingEngine.reset();
+    delete pendingDelayLines.exchange(nullptr);
+    replacedDelayLines.reset();
+    replacedDelayLinesReader = nullptr;
+    swapInPendingBanks();
+    engine = std::make_unique<MultiResolutionEngine>(*this, config);
+    engine->prepareBanks(getActiveBanks());
+
+    wetBuffer.setSize(config.numChannels, std::max(samplesPerBlock, 1));
+    fadeBuffer.setSize(config.numChannels, std::max(samplesPerBlock, 1));
+    engineCrossfadeLength = std::max(1, juce::roundToInt(0.02 * sampleRate)); // 20 ms
+
+    // Report latency to host for delay compensation
+    engineLatency = engine->getLatencySamples();
+    engineWarmupSamples = engine->getWarmupSamples();
+    quietSamples = 0;
+    engineIdle = false;
+    setLatencySamples(engineLatency.load());
+
+    DEBUG_LOG("=== prepareToPlay completed ===");
+}
+
+int SpectrasaurusAudioProcessor::computeMaxDelaySamples(double sampleRate) const
+{
     // Compute delay buffer size from actual bank settings (not a fixed max)
     float maxDelayMs = 0.0f;
     for (auto& bank : banks)
@@ -93,124 +251,338 @@ void SpectrasaurusAudioProcessor::prepareToPlay (double sampleRate, int samplesP
         maxDelayMs = std::max(maxDelayMs, bank.delayMaxTimeMsR);
     }
     maxDelayMs = std::max(maxDelayMs, 1000.0f); // minimum 1 second capacity
-    maxDelaySamples = static_cast<int>((maxDelayMs / 1000.0f) * sampleRate);
+    return static_cast<int>((maxDelayMs / 1000.0f) * sampleRate);
+}
 
-    DEBUG_LOG("FFT size: ", currentFFTSize);
-    DEBUG_LOG("Overlap factor: ", currentOverlapFactor);
-    DEBUG_LOG("Max delay samples: ", maxDelaySamples);
+void SpectrasaurusAudioProcessor::reallocateDelayBuffersIfNeeded()
+{
+    {
+        const juce::ScopedLock sl(engineConfigLock);
+        int needed = computeMaxDelaySamples(engineConfig.sampleRate);
+        if (needed <= engineConfig.maxDelaySamples)
+            return; // current allocation is sufficient
 
-    int fftOrder = static_cast<int>(std::log2(currentFFTSize));
-    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
-    window = std::make_unique<juce::dsp::WindowingFunction<float>>(
-        static_cast<size_t>(currentFFTSize),
-        juce::dsp::WindowingFunction<float>::hann);
+        engineConfig.maxDelaySamples = needed;
+    }
 
-    // Allocate buffers - output needs to be larger for overlap-add
-    int hopSize = currentFFTSize / currentOverlapFactor;
-    inputBuffer.setSize(2, currentFFTSize);
-    outputBuffer.setSize(2, currentFFTSize * 2); // 2x size for proper overlap-add
-    fftBuffer.setSize(2, currentFFTSize * 2);
+    // An engine built or still being built with the old capacity holds its delays
+    // to it and asks for larger lines in turn
+    delayResizeRequested = true;
+    engineBuilder->notify();
+}
 
-    inputBuffer.clear();
-    outputBuffer.clear();
-    fftBuffer.clear();
+juce::Array<int> SpectrasaurusAudioProcessor::getAvailableFFTSizes()
+{
+    // Non-power-of-two sizes run on the mixed-radix backend
+    return { 256, 512, 1024, 1536, 2048, 3072, 4096, 6144, 8192 };
+}
 
-    leftFFTData.resize(currentFFTSize * 2, 0.0f);
-    rightFFTData.resize(currentFFTSize * 2, 0.0f);
+juce::Array<int> SpectrasaurusAudioProcessor::getAvailableOverlapFactors()
+{
+    return { 2, 4, 8 };
+}
 
-    inputBufferWritePos = 0;
-    outputBufferReadPos = 0;
-    // Start writing ahead of reading by one FFT size
-    outputBufferWritePos = currentFFTSize;
+void SpectrasaurusAudioProcessor::setFFTSettings(const FFTSettings& settings)
+{
+    if (!getAvailableFFTSizes().contains(settings.fftSize)
+        || !getAvailableOverlapFactors().contains(settings.overlapFactor)
+        || !STFTWindowPair::isValid(static_cast<int>(settings.window))
+        || settings.numBands < 1 || settings.numBands > MultiResolutionEngine::kMaxBands)
+        return;
 
-    // Report latency to host for delay compensation
-    setLatencySamples(currentFFTSize);
-
-    // Allocate delay buffers (sized in frames, not samples)
-    int numBins = currentFFTSize / 2;
-    int maxDelayFrames = maxDelaySamples / hopSize;
-
-    leftBinDelayBuffers.clear();
-    rightBinDelayBuffers.clear();
-    leftBinDelayWritePos.clear();
-    rightBinDelayWritePos.clear();
-
-    // Allocate feedback buffers
-    feedbackLeftReal.assign(numBins, 0.0f);
-    feedbackLeftImag.assign(numBins, 0.0f);
-    feedbackRightReal.assign(numBins, 0.0f);
-    feedbackRightImag.assign(numBins, 0.0f);
-
-    // Pre-allocate working buffers for processFFTFrame (no heap alloc on audio thread)
-    tempLeftReal.resize(numBins);
-    tempLeftImag.resize(numBins);
-    tempRightReal.resize(numBins);
-    tempRightImag.resize(numBins);
-    shiftedLeftReal.resize(numBins);
-    shiftedLeftImag.resize(numBins);
-    shiftedRightReal.resize(numBins);
-    shiftedRightImag.resize(numBins);
-    allParams.resize(numBins);
-
-    DEBUG_LOG("Allocating delay buffers for ", numBins, " bins, ", maxDelayFrames, " frames each");
-
-    for (int i = 0; i < numBins; ++i)
     {
-        // Each bin buffer stores: channel 0 = real, channel 1 = imag
-        leftBinDelayBuffers.emplace_back(2, maxDelayFrames);
-        rightBinDelayBuffers.emplace_back(2, maxDelayFrames);
-        leftBinDelayBuffers[i].clear();
-        rightBinDelayBuffers[i].clear();
-        leftBinDelayWritePos.push_back(0);
-        rightBinDelayWritePos.push_back(0);
+        const juce::ScopedLock sl(engineConfigLock);
+        engineConfig.fftSize = settings.fftSize;
+        engineConfig.overlapFactor = settings.overlapFactor;
+        engineConfig.window = settings.window;
+        engineConfig.numBands = settings.numBands;
     }
 
-    DEBUG_LOG("=== prepareToPlay completed ===");
+    // After the config, so this snapshot is compiled for the new engine's layouts
+    for (auto& bank : banks)
+    {
+        bank.fftSize = settings.fftSize;
+        bank.overlapFactor = settings.overlapFactor;
+    }
+    publishBanks();
+
+    engineRebuildRequested = true;
+    engineBuilder->notify();
 }
 
-void SpectrasaurusAudioProcessor::reallocateDelayBuffersIfNeeded()
+void SpectrasaurusAudioProcessor::setHalfPrecisionDelays(bool shouldUseHalfPrecision)
 {
-    float maxDelayMs = 0.0f;
-    for (auto& bank : banks)
     {
-        maxDelayMs = std::max(maxDelayMs, bank.delayMaxTimeMsL);
-        maxDelayMs = std::max(maxDelayMs, bank.delayMaxTimeMsR);
+        const juce::ScopedLock sl(engineConfigLock);
+        engineConfig.halfPrecisionDelays = shouldUseHalfPrecision;
+    }
+
+    engineRebuildRequested = true;
+    engineBuilder->notify();
+}
+
+bool SpectrasaurusAudioProcessor::getHalfPrecisionDelays() const
+{
+    const juce::ScopedLock sl(engineConfigLock);
+    return engineConfig.halfPrecisionDelays;
+}
+
+SpectrasaurusAudioProcessor::FFTSettings SpectrasaurusAudioProcessor::getFFTSettings() const
+{
+    const juce::ScopedLock sl(engineConfigLock);
+    FFTSettings settings;
+    settings.fftSize = engineConfig.fftSize;
+    settings.overlapFactor = engineConfig.overlapFactor;
+    settings.window = engineConfig.window;
+    settings.numBands = engineConfig.numBands;
+    return settings;
+}
+
+void SpectrasaurusAudioProcessor::buildPendingEngine()
+{
+    MultiResolutionEngine::Config config;
+    {
+        const juce::ScopedLock sl(engineConfigLock);
+        config = engineConfig;
+        if (config.sampleRate <= 0.0 || config == publishedConfig)
+            return; // not prepared yet, or already running this configuration
+    }
+
+    DEBUG_LOG("Rebuilding engine - FFT size: ", config.fftSize, " overlap: ", config.overlapFactor);
+
+    // The active snapshot stays alive while we read it: once the audio thread
+    // retires it, only this thread frees it, and not before this returns
+    auto newEngine = std::make_unique<MultiResolutionEngine>(*this, config);
+    newEngine->prepareBanks(getActiveBanks());
+
+    const juce::ScopedLock sl(engineConfigLock);
+    if (engineConfig != config)
+    {
+        engineRebuildRequested = true; // settings moved on while building — try again
+        return;
+    }
+
+    publishedConfig = config;
+    delete pendingEngine.exchange(newEngine.release());
+}
+
+void SpectrasaurusAudioProcessor::swapInPendingEngine()
+{
+    // Hand a finished crossfade's engine to the builder thread for deletion. If the
+    // slot is still occupied, keep it (silent) until the next block.
+    if (fadingEngine != nullptr && engineWarmupRemaining == 0 && engineCrossfadePos >= engineCrossfadeLength
+        && retiredEngine.load() == nullptr)
+    {
+        retiredEngine = fadingEngine.release();
+    }
+
+    if (fadingEngine != nullptr)
+        return; // one swap at a time
+
+    auto* next = pendingEngine.exchange(nullptr);
+    if (next == nullptr)
+        return;
+
+    fadingEngine = std::move(engine);
+    engine.reset(next);
+    engineLatency = engine->getLatencySamples();
+    engineWarmupSamples = engine->getWarmupSamples();
+
+    if (fadingEngine == nullptr)
+    {
+        engineLatencyChanged = true;
+        return;
+    }
+
+    // Keep playing the old engine until the new one's overlap-add is complete
+    engineWarmupRemaining = engine->getWarmupSamples();
+    engineCrossfadePos = 0;
+}
+
+void SpectrasaurusAudioProcessor::buildPendingDelayLines()
+{
+    MultiResolutionEngine::Config config;
+    {
+        const juce::ScopedLock sl(engineConfigLock);
+        config = engineConfig;
+        auto running = publishedConfig;
+        running.maxDelaySamples = config.maxDelaySamples;
+        if (config.sampleRate <= 0.0 || config != running)
+            return; // not prepared yet, or a new engine (sized from scratch) is on its way
     }
-    maxDelayMs = std::max(maxDelayMs, 1000.0f);
-    int needed = static_cast<int>((maxDelayMs / 1000.0f) * currentSampleRate);
 
-    if (needed <= maxDelaySamples)
-        return; // current allocation is sufficient
+    DEBUG_LOG("Rebuilding delay lines - max delay samples: ", config.maxDelaySamples);
 
-    suspendProcessing(true);
+    // compiledBanks are the latest this thread has seen, so the lines also cover
+    // a snapshot the audio thread hasn't picked up yet
+    auto lines = MultiResolutionEngine::createDelayLines(config, compiledBanks);
 
-    maxDelaySamples = needed;
-    int hopSize = currentFFTSize / currentOverlapFactor;
-    int numBins = currentFFTSize / 2;
-    int maxDelayFrames = maxDelaySamples / hopSize;
+    const juce::ScopedLock sl(engineConfigLock);
+    if (engineConfig != config)
+    {
+        delayResizeRequested = true; // settings moved on while building — try again
+        return;
+    }
 
-    leftBinDelayBuffers.clear();
-    rightBinDelayBuffers.clear();
-    leftBinDelayWritePos.clear();
-    rightBinDelayWritePos.clear();
+    publishedConfig.maxDelaySamples = config.maxDelaySamples;
+    delete pendingDelayLines.exchange(lines.release());
+}
 
-    for (int i = 0; i < numBins; ++i)
+void SpectrasaurusAudioProcessor::swapInPendingDelayLines()
+{
+    // Hand replaced lines to the builder thread once no engine reads them. Until
+    // then (or while the slot is occupied) new lines wait.
+    if (replacedDelayLines != nullptr)
     {
-        leftBinDelayBuffers.emplace_back(2, maxDelayFrames);
-        rightBinDelayBuffers.emplace_back(2, maxDelayFrames);
-        leftBinDelayBuffers[i].clear();
-        rightBinDelayBuffers[i].clear();
-        leftBinDelayWritePos.push_back(0);
-        rightBinDelayWritePos.push_back(0);
+        const bool stillRead = (replacedDelayLinesReader == engine.get() || replacedDelayLinesReader == fadingEngine.get())
+                            && replacedDelayLinesReader->isReadingPreviousDelayLines();
+        if (stillRead || retiredDelayLines.load() != nullptr)
+            return;
+
+        retiredDelayLines = replacedDelayLines.release();
+        replacedDelayLinesReader = nullptr;
     }
 
-    // Clear feedback buffers (stale feedback from old buffer layout)
-    std::fill(feedbackLeftReal.begin(), feedbackLeftReal.end(), 0.0f);
-    std::fill(feedbackLeftImag.begin(), feedbackLeftImag.end(), 0.0f);
-    std::fill(feedbackRightReal.begin(), feedbackRightReal.end(), 0.0f);
-    std::fill(feedbackRightImag.begin(), feedbackRightImag.end(), 0.0f);
+    if (engine == nullptr)
+        return;
+
+    auto* lines = pendingDelayLines.exchange(nullptr);
+    if (lines == nullptr)
+        return;
+
+    // Lines made for an engine that has since been replaced just go back
+    if (engine->takeOverDelayLines(*lines))
+        replacedDelayLinesReader = engine.get();
+    replacedDelayLines.reset(lines);
+}
+
+void SpectrasaurusAudioProcessor::publishBanks()
+{
+    publishedBanks = banks;
+
+    auto* snapshot = new BankSnapshot { banks, {} };
+
+    // A snapshot the builder hasn't started on yet can be freed right here
+    delete queuedBankSnapshot.exchange(snapshot);
+    engineBuilder->notify();
+}
 
-    suspendProcessing(false);
+void SpectrasaurusAudioProcessor::publishBanksIfChanged()
+{
+    if (banks != publishedBanks)
+        publishBanks();
+}
+
+void SpectrasaurusAudioProcessor::compileQueuedBanks()
+{
+    auto* snapshot = queuedBankSnapshot.exchange(nullptr);
+    const bool recompile = bankRecompileRequested.exchange(false);
+    if (snapshot == nullptr)
+    {
+        if (!recompile)
+            return;
+        snapshot = new BankSnapshot { compiledBanks, {} };
+    }
+    compiledBanks = snapshot->banks;
+    snapshot->activeStages = BankSnapshot::findActiveStages(snapshot->banks);
+
+    std::vector<CurveTableLayout> layouts;
+    {
+        const juce::ScopedLock sl(engineConfigLock);
+        if (engineConfig.sampleRate > 0.0)
+        {
+            layouts = MultiResolutionEngine::getCurveTableLayouts(engineConfig);
+            // Hosts pick this up the next time they ask for the tail. Telling them
+            // it changed would mean a latency change, and many hosts re-prepare
+            // the plugin for that.
+            echoTailSeconds = MultiResolutionEngine::getEchoTailSeconds(engineConfig, compiledBanks);
+        }
+    }
+
+    // Tables for curves the active snapshot has too are copied from it; the rest
+    // are evaluated in parallel. The active snapshot stays alive while we read it,
+    // as in buildPendingEngine.
+    struct CurveJob
+    {
+        const PiecewiseFunction* curve;
+        const CurveTableLayout* layout;
+        float* dest;
+    };
+    std::vector<CurveJob> jobs;
+
+    const auto& active = getActiveBankSnapshot();
+    snapshot->curveTables.resize(layouts.size());
+    for (size_t i = 0; i < layouts.size(); ++i)
+    {
+        auto& tables = snapshot->curveTables[i];
+        tables.allocate(layouts[i]);
+        const auto* previous = active.findCurveTables(layouts[i]);
+
+        for (size_t b = 0; b < snapshot->banks.size(); ++b)
+        {
+            for (size_t c = 0; c < CurveTables::kNumCurves; ++c)
+            {
+                auto type = static_cast<CurveType>(c);
+                auto& curve = snapshot->banks[b].getCurve(type);
+                if (previous != nullptr && curve == active.banks[b].getCurve(type))
+                {
+                    tables.curves[b][c] = previous->curves[b][c];
+                    tables.ids[b][c] = previous->ids[b][c];
+                }
+                else
+                {
+                    jobs.push_back({ &curve, &tables.layout, tables.curves[b][c].data() });
+                    tables.ids[b][c] = CurveTables::getNextId();
+                }
+            }
+        }
+    }
+
+    // Curves are claimed one at a time by this thread and the pool's helpers
+    std::atomic<size_t> nextJob { 0 };
+    auto compileCurves = [&]
+    {
+        for (size_t j = nextJob++; j < jobs.size(); j = nextJob++)
+            CurveTables::fillCurve(*jobs[j].curve, *jobs[j].layout, jobs[j].dest);
+    };
+
+    const int numHelpers = juce::jmin(curveCompilePool.getNumThreads(), static_cast<int>(jobs.size()) - 1);
+    std::atomic<int> helpersRunning { juce::jmax(0, numHelpers) };
+    for (int i = 0; i < numHelpers; ++i)
+    {
+        curveCompilePool.addJob([&]
+        {
+            compileCurves();
+            if (--helpersRunning == 0)
+                curveCompileDone.signal();
+            return juce::ThreadPoolJob::jobHasFinished;
+        });
+    }
+
+    compileCurves();
+    while (helpersRunning.load() > 0)
+        curveCompileDone.wait(100);
+
+    // A compiled snapshot the audio thread never picked up can be freed right here
+    delete pendingBankSnapshot.exchange(snapshot);
+}
+
+void SpectrasaurusAudioProcessor::swapInPendingBanks()
+{
+    // The replaced snapshot goes to the builder thread for deletion. If the slot
+    // is still occupied, keep the current one until a later block.
+    if (retiredBankSnapshot.load() != nullptr)
+        return;
+
+    if (auto* next = pendingBankSnapshot.exchange(nullptr))
+        retiredBankSnapshot = activeBankSnapshot.exchange(next);
+}
+
+void SpectrasaurusAudioProcessor::timerCallback()
+{
+    // Only tells the host when the latency actually changed
+    if (engineLatencyChanged.exchange(false))
+        setLatencySamples(engineLatency.load());
 }
 
 void SpectrasaurusAudioProcessor::releaseResources()
@@ -219,10 +591,15 @@ void SpectrasaurusAudioProcessor::releaseResources()
 
 bool SpectrasaurusAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout the engine has channels for (mono up to 7.1.4 and beyond), the
+    // same in and out. Channels pair up by type, the left of each pair on the left
+    // curves; centre, LFE and other lone channels run on the mean of the two (see
+    // SpectralEngine::pairChannels).
+    const auto& output = layouts.getMainOutputChannelSet();
+    if (output.isDisabled() || output.size() > SpectralEngine::kMaxChannels)
         return false;
 
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    if (output != layouts.getMainInputChannelSet())
         return false;
 
     return true;
@@ -241,7 +618,7 @@ void SpectrasaurusAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    if (totalNumInputChannels < 2 || totalNumOutputChannels < 2)
+    if (totalNumInputChannels < 1 || totalNumOutputChannels < 1)
         return;
 
     blockCounter++;
@@ -249,14 +626,34 @@ void SpectrasaurusAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     // Log first few blocks and then occasionally
     if (blockCounter <= 5 || blockCounter % 100 == 0)
     {
-        DEBUG_LOG("processBlock #", blockCounter, " - samples: ", buffer.getNumSamples());
+        DEBUG_LOG("processBlock #", blockCounter, " - samples: ", buffer.getNumSamples(),
+                  " channels: ", totalNumInputChannels);
         float maxL = buffer.getMagnitude(0, 0, buffer.getNumSamples());
-        float maxR = buffer.getMagnitude(1, 0, buffer.getNumSamples());
+        float maxR = buffer.getMagnitude(std::min(1, totalNumInputChannels - 1), 0, buffer.getNumSamples());
         DEBUG_LOG("  Input levels - L: ", maxL, " R: ", maxR);
     }
 
-    int hopSize = currentFFTSize / currentOverlapFactor;
+    swapInPendingBanks();
+    swapInPendingEngine();
+    swapInPendingDelayLines();
+    // The engine is built for the bus layout prepareToPlay saw
+    if (engine == nullptr || engine->getConfig().numChannels > std::min(totalNumInputChannels, buffer.getNumChannels()))
+        return;
+
     int numSamples = buffer.getNumSamples();
+    const int numChannels = engine->getConfig().numChannels;
+
+    // Go idle once the input has been silent for as long as the engine needs to
+    // play out everything it still holds; any input above the threshold wakes it
+    bool inputIsSilent = true;
+    for (int channel = 0; channel < numChannels; ++channel)
+        inputIsSilent = inputIsSilent && buffer.getMagnitude(channel, 0, numSamples) < SpectralEngine::kSilenceThreshold;
+    if (inputIsSilent && fadingEngine == nullptr && engine->hasDecayed())
+        quietSamples = std::min(quietSamples + numSamples, engine->getWarmupSamples());
+    else
+        quietSamples = 0;
+
+    engineIdle = quietSamples >= engine->getWarmupSamples();
 
     float maxOutputL = 0.0f;
     float maxOutputR = 0.0f;
@@ -269,114 +666,103 @@ void SpectrasaurusAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     float wC = (1.0f - mx) * my;
     float wD = mx * my;
 
-    float bankGainDB, bankClipDB, bankPan;
-    {
-        juce::SpinLock::ScopedLockType lock(bankLock);
-        bankGainDB = wA * banks[0].gainDB + wB * banks[1].gainDB +
-                     wC * banks[2].gainDB + wD * banks[3].gainDB;
-        bankClipDB = wA * banks[0].softClipThresholdDB + wB * banks[1].softClipThresholdDB +
-                     wC * banks[2].softClipThresholdDB + wD * banks[3].softClipThresholdDB;
-        bankPan = wA * banks[0].panValue + wB * banks[1].panValue +
-                  wC * banks[2].panValue + wD * banks[3].panValue;
-    }
-
-    float bankGain = juce::Decibels::decibelsToGain(bankGainDB);
-    float bankClipT = juce::Decibels::decibelsToGain(bankClipDB);
-    bool doBankClip = bankClipDB < -0.01f;
+    const auto& activeBanks = getActiveBanks();
+    float bankGainDB = wA * activeBanks[0].gainDB + wB * activeBanks[1].gainDB +
+                       wC * activeBanks[2].gainDB + wD * activeBanks[3].gainDB;
+    float bankClipDB = wA * activeBanks[0].softClipThresholdDB + wB * activeBanks[1].softClipThresholdDB +
+                       wC * activeBanks[2].softClipThresholdDB + wD * activeBanks[3].softClipThresholdDB;
+    float bankPan = wA * activeBanks[0].panValue + wB * activeBanks[1].panValue +
+                    wC * activeBanks[2].panValue + wD * activeBanks[3].panValue;
+
+    OutputStage::Settings output;
+    output.bankGain = juce::Decibels::decibelsToGain(bankGainDB);
+    output.bankClip = bankClipDB < -0.01f;
+    output.bankClipThreshold = juce::Decibels::decibelsToGain(bankClipDB);
     // Convert pan (-1..+1) to equal-power gains, normalized so center = unity
     float panAngle = (bankPan + 1.0f) * 0.5f * static_cast<float>(M_PI) * 0.5f;
-    float panGainL = std::cos(panAngle) * std::sqrt(2.0f);
-    float panGainR = std::sin(panAngle) * std::sqrt(2.0f);
+    output.panGainL = std::cos(panAngle) * std::sqrt(2.0f);
+    output.panGainR = std::sin(panAngle) * std::sqrt(2.0f);
 
-    // Compute master gain/clip once per block
-    float mGain = juce::Decibels::decibelsToGain(masterGainDB.load());
+    output.masterGain = juce::Decibels::decibelsToGain(masterGainDB.load());
     float mClipDB = masterClipDB.load();
-    float mClipT = juce::Decibels::decibelsToGain(mClipDB);
-    bool doMasterClip = mClipDB < -0.01f;
-
-    // Dry/wet mix (0 = dry, 1 = wet)
-    float dryWet = masterDryWet.load();
+    output.masterClip = mClipDB < -0.01f;
+    output.masterClipThreshold = juce::Decibels::decibelsToGain(mClipDB);
+    output.dryWet = masterDryWet.load();
+    outputStage.prepare(output);
+
+    // Run the engines in sub-blocks that fit the wet buffers, then apply the
+    // output stage with the original input as the dry signal
+    std::array<float*, SpectralEngine::kMaxChannels> out {}, wet {}, fade {};
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        wet[static_cast<size_t>(channel)] = wetBuffer.getWritePointer(channel);
+        fade[static_cast<size_t>(channel)] = fadeBuffer.getWritePointer(channel);
+    }
 
-    for (int sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx)
+    int blockStart = 0;
+    while (blockStart < numSamples)
     {
-        // Write input samples to buffer
-        inputBuffer.setSample(0, inputBufferWritePos, buffer.getSample(0, sampleIdx));
-        inputBuffer.setSample(1, inputBufferWritePos, buffer.getSample(1, sampleIdx));
-
-        // Read output samples from buffer (post overlap-add)
-        float sampleL = outputBuffer.getSample(0, outputBufferReadPos);
-        float sampleR = outputBuffer.getSample(1, outputBufferReadPos);
-
-        // Apply bank gain (morphed)
-        sampleL *= bankGain;
-        sampleR *= bankGain;
+        int len = std::min(numSamples - blockStart, wetBuffer.getNumSamples());
+        for (int channel = 0; channel < numChannels; ++channel)
+            out[static_cast<size_t>(channel)] = buffer.getWritePointer(channel) + blockStart;
 
-        // Apply bank soft clip (operates on final summed signal, not per-frame)
-        if (doBankClip)
+        if (engineIdle)
         {
-            sampleL = bankClipT * std::tanh(sampleL / bankClipT);
-            sampleR = bankClipT * std::tanh(sampleR / bankClipT);
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::clear(wet[static_cast<size_t>(channel)], len);
         }
-
-        // Apply per-bank pan (equal-power)
-        sampleL *= panGainL;
-        sampleR *= panGainR;
-
-        // Apply master gain
-        sampleL *= mGain;
-        sampleR *= mGain;
-
-        // Apply master soft clip (tanh)
-        if (doMasterClip)
-        {
-            sampleL = mClipT * std::tanh(sampleL / mClipT);
-            sampleR = mClipT * std::tanh(sampleR / mClipT);
-        }
-
-        // Dry/wet mix: blend processed (wet) with original dry signal
-        if (dryWet < 1.0f)
+        else
         {
-            float dryL = buffer.getSample(0, sampleIdx);
-            float dryR = buffer.getSample(1, sampleIdx);
-            sampleL = dryL + dryWet * (sampleL - dryL);
-            sampleR = dryR + dryWet * (sampleR - dryR);
+            engine->process(out.data(), wet.data(), len, true);
         }
 
-        buffer.setSample(0, sampleIdx, sampleL);
-        buffer.setSample(1, sampleIdx, sampleR);
-
-        // Track peak levels for metering
-        maxOutputL = std::max(maxOutputL, std::abs(sampleL));
-        maxOutputR = std::max(maxOutputR, std::abs(sampleR));
-
-        // Clear the read position
-        outputBuffer.setSample(0, outputBufferReadPos, 0.0f);
-        outputBuffer.setSample(1, outputBufferReadPos, 0.0f);
-
-        inputBufferWritePos++;
-        outputBufferReadPos = (outputBufferReadPos + 1) % outputBuffer.getNumSamples();
-
-        // Process when we have filled the entire FFT window
-        if (inputBufferWritePos >= currentFFTSize)
+        if (fadingEngine != nullptr)
         {
-            processFFTFrame();
+            fadingEngine->process(out.data(), fade.data(), len, false);
 
-            // Shift input buffer left by hopSize samples
-            for (int i = 0; i < currentFFTSize - hopSize; ++i)
+            // Old engine only while the new one warms up, then a linear crossfade
+            const int warmup = std::min(len, engineWarmupRemaining);
+            const int crossfade = std::min(len - warmup, engineCrossfadeLength - engineCrossfadePos);
+            for (size_t channel = 0; channel < static_cast<size_t>(numChannels); ++channel)
             {
-                inputBuffer.setSample(0, i, inputBuffer.getSample(0, i + hopSize));
-                inputBuffer.setSample(1, i, inputBuffer.getSample(1, i + hopSize));
+                juce::FloatVectorOperations::copy(wet[channel], fade[channel], warmup);
+                for (int i = warmup; i < warmup + crossfade; ++i)
+                {
+                    float g = static_cast<float>(engineCrossfadePos + i - warmup) / static_cast<float>(engineCrossfadeLength);
+                    wet[channel][i] = fade[channel][i] + g * (wet[channel][i] - fade[channel][i]);
+                }
             }
-            // Clear the newly available space at the end
-            for (int i = currentFFTSize - hopSize; i < currentFFTSize; ++i)
+            engineCrossfadePos += crossfade;
+            if (warmup > 0)
             {
-                inputBuffer.setSample(0, i, 0.0f);
-                inputBuffer.setSample(1, i, 0.0f);
+                engineWarmupRemaining -= warmup;
+                if (engineWarmupRemaining == 0)
+                    engineLatencyChanged = true; // new latency is now what the host hears
             }
+        }
 
-            // Reset write position to where new samples should go
-            inputBufferWritePos = currentFFTSize - hopSize;
+        // Each pair's left channel is on the left curves and meter, its right one on
+        // the right; lone channels (mid pairs) take no pan and show on both meters
+        const auto& engineLayout = engine->getConfig();
+        for (size_t k = 0; k < static_cast<size_t>(engineLayout.numPairs); ++k)
+        {
+            const auto& pairing = engineLayout.pairs[k];
+            for (const int channel : { pairing.left, pairing.right })
+            {
+                if (channel < 0)
+                    continue;
+                const size_t c = static_cast<size_t>(channel);
+                const auto side = pairing.mid ? OutputStage::Centre
+                                              : (channel == pairing.left ? OutputStage::Left : OutputStage::Right);
+                const float peak = outputStage.process(side, wet[c], out[c], len);
+                if (side != OutputStage::Right)
+                    maxOutputL = std::max(maxOutputL, peak);
+                if (side != OutputStage::Left)
+                    maxOutputR = std::max(maxOutputR, peak);
+            }
         }
+
+        blockStart += len;
     }
 
     // Update level meters (smoothed peak decay)
@@ -417,6 +803,12 @@ void SpectrasaurusAudioProcessor::getStateInformation (juce::MemoryBlock& destDa
     root->setProperty("masterClipDB", static_cast<double>(masterClipDB.load()));
     root->setProperty("masterDryWet", static_cast<double>(masterDryWet.load()));
     root->setProperty("notesText", notesText);
+    auto fftSettings = getFFTSettings();
+    root->setProperty("fftSize", fftSettings.fftSize);
+    root->setProperty("overlapFactor", fftSettings.overlapFactor);
+    root->setProperty("fftWindow", static_cast<int>(fftSettings.window));
+    root->setProperty("fftBands", fftSettings.numBands);
+    root->setProperty("halfPrecisionDelays", getHalfPrecisionDelays());
 
     // UI view state
     root->setProperty("dynamicsLCurveIndex", dynamicsLCurveIndex);
@@ -457,10 +849,10 @@ void SpectrasaurusAudioProcessor::setStateInformation (const void* data, int siz
         auto banksVar = root->getProperty("banks");
         if (auto* banksArray = banksVar.getArray())
         {
-            juce::SpinLock::ScopedLockType lock(bankLock);
             int count = std::min(static_cast<int>(banksArray->size()), 4);
             for (int i = 0; i < count; ++i)
                 banks[i].fromVar((*banksArray)[i]);
+            publishBanks();
         }
 
         if (root->hasProperty("morphX"))
@@ -486,6 +878,20 @@ void SpectrasaurusAudioProcessor::setStateInformation (const void* data, int siz
         if (root->hasProperty("notesText"))
             notesText = root->getProperty("notesText").toString();
 
+        // FFT settings (backward compatible — older states keep the current settings)
+        auto fftSettings = getFFTSettings();
+        if (root->hasProperty("fftSize"))
+            fftSettings.fftSize = static_cast<int>(root->getProperty("fftSize"));
+        if (root->hasProperty("overlapFactor"))
+            fftSettings.overlapFactor = static_cast<int>(root->getProperty("overlapFactor"));
+        if (root->hasProperty("fftWindow"))
+            fftSettings.window = static_cast<STFTWindow>(static_cast<int>(root->getProperty("fftWindow")));
+        if (root->hasProperty("fftBands"))
+            fftSettings.numBands = static_cast<int>(root->getProperty("fftBands"));
+        setFFTSettings(fftSettings);
+        if (root->hasProperty("halfPrecisionDelays"))
+            setHalfPrecisionDelays(static_cast<bool>(root->getProperty("halfPrecisionDelays")));
+
         // UI view state (backward compatible — defaults to 0 if absent)
         if (root->hasProperty("dynamicsLCurveIndex"))
             dynamicsLCurveIndex = static_cast<int>(root->getProperty("dynamicsLCurveIndex"));
@@ -527,618 +933,6 @@ void SpectrasaurusAudioProcessor::setStateInformation (const void* data, int siz
     }
 }
 
-SpectrasaurusAudioProcessor::BinParameters SpectrasaurusAudioProcessor::evaluateBinParameters(
-    int binIndex, const SkipFlags& skip,
-    float wA, float wB, float wC, float wD)
-{
-    BinParameters params;
-
-    // Helper: read precomputed LUT values and morph-interpolate across 4 banks
-    auto evalCurve4 = [&](CurveType ct) -> float
-    {
-        int ci = static_cast<int>(ct);
-        return wA * banks[0].curveLUT[ci][binIndex]
-             + wB * banks[1].curveLUT[ci][binIndex]
-             + wC * banks[2].curveLUT[ci][binIndex]
-             + wD * banks[3].curveLUT[ci][binIndex];
-    };
-
-    // Delay curves
-    if (!skip.delay)
-    {
-        float delayLNorm = evalCurve4(CurveType::DelayL);
-        float delayRNorm = evalCurve4(CurveType::DelayR);
-
-        float delayMaxMsL = wA * banks[0].delayMaxTimeMsL + wB * banks[1].delayMaxTimeMsL +
-                            wC * banks[2].delayMaxTimeMsL + wD * banks[3].delayMaxTimeMsL;
-        float delayMaxMsR = wA * banks[0].delayMaxTimeMsR + wB * banks[1].delayMaxTimeMsR +
-                            wC * banks[2].delayMaxTimeMsR + wD * banks[3].delayMaxTimeMsR;
-
-        float logScaleWeightL = wA * (banks[0].delayLogScaleL ? 1.0f : 0.0f) +
-                                wB * (banks[1].delayLogScaleL ? 1.0f : 0.0f) +
-                                wC * (banks[2].delayLogScaleL ? 1.0f : 0.0f) +
-                                wD * (banks[3].delayLogScaleL ? 1.0f : 0.0f);
-        float logScaleWeightR = wA * (banks[0].delayLogScaleR ? 1.0f : 0.0f) +
-                                wB * (banks[1].delayLogScaleR ? 1.0f : 0.0f) +
-                                wC * (banks[2].delayLogScaleR ? 1.0f : 0.0f) +
-                                wD * (banks[3].delayLogScaleR ? 1.0f : 0.0f);
-        bool useLogScaleL = logScaleWeightL > 0.5f;
-        bool useLogScaleR = logScaleWeightR > 0.5f;
-
-        if (useLogScaleL)
-            params.delayL = std::pow(delayMaxMsL, delayLNorm) / 1000.0f * currentSampleRate;
-        else
-            params.delayL = (delayLNorm * delayMaxMsL) / 1000.0f * currentSampleRate;
-
-        if (useLogScaleR)
-            params.delayR = std::pow(delayMaxMsR, delayRNorm) / 1000.0f * currentSampleRate;
-        else
-            params.delayR = (delayRNorm * delayMaxMsR) / 1000.0f * currentSampleRate;
-    }
-    else
-    {
-        params.delayL = 0.0f;
-        params.delayR = 0.0f;
-    }
-
-    // Pan curves
-    if (!skip.pan)
-    {
-        params.panL = evalCurve4(CurveType::PanL);
-        params.panR = evalCurve4(CurveType::PanR);
-    }
-    else
-    {
-        params.panL = 0.0f;
-        params.panR = 0.0f;
-    }
-
-    // Feedback curves
-    if (!skip.feedback)
-    {
-        float fbLNorm = evalCurve4(CurveType::FeedbackL);
-        float fbRNorm = evalCurve4(CurveType::FeedbackR);
-
-        if (fbLNorm <= 0.0f)
-            params.feedbackL = 0.0f;
-        else
-            params.feedbackL = std::pow(10.0f, ((fbLNorm * 66.0f) - 60.0f) / 20.0f);
-
-        if (fbRNorm <= 0.0f)
-            params.feedbackR = 0.0f;
-        else
-            params.feedbackR = std::pow(10.0f, ((fbRNorm * 66.0f) - 60.0f) / 20.0f);
-    }
-    else
-    {
-        params.feedbackL = 0.0f;
-        params.feedbackR = 0.0f;
-    }
-
-    // Dynamics curves
-    if (!skip.dynamics)
-    {
-        auto interpolateDynamicsCurve = [&](CurveType ct) -> float
-        {
-            float norm = evalCurve4(ct);
-            if (norm <= 0.0f) return 0.0f;
-            float dB = (norm * 60.0f) - 60.0f;
-            return std::pow(10.0f, dB / 20.0f);
-        };
-
-        params.preGainL = interpolateDynamicsCurve(CurveType::PreGainL);
-        params.preGainR = interpolateDynamicsCurve(CurveType::PreGainR);
-        params.minGateL = interpolateDynamicsCurve(CurveType::MinGateL);
-        params.minGateR = interpolateDynamicsCurve(CurveType::MinGateR);
-        params.maxClipL = interpolateDynamicsCurve(CurveType::MaxClipL);
-        params.maxClipR = interpolateDynamicsCurve(CurveType::MaxClipR);
-    }
-    else
-    {
-        params.preGainL = 1.0f;
-        params.preGainR = 1.0f;
-        params.minGateL = 0.0f;
-        params.minGateR = 0.0f;
-        params.maxClipL = 1.0f;
-        params.maxClipR = 1.0f;
-    }
-
-    // Shift/multiply curves
-    if (!skip.shift)
-    {
-        params.shiftL = evalCurve4(CurveType::ShiftL);
-        params.shiftR = evalCurve4(CurveType::ShiftR);
-        params.multiplyL = evalCurve4(CurveType::MultiplyL);
-        params.multiplyR = evalCurve4(CurveType::MultiplyR);
-    }
-    else
-    {
-        params.shiftL = 0.5f;
-        params.shiftR = 0.5f;
-        params.multiplyL = 0.5f;
-        params.multiplyR = 0.5f;
-    }
-
-    return params;
-}
-
-void SpectrasaurusAudioProcessor::processFFTFrame()
-{
-    frameCounter++;
-    bool shouldLog = (frameCounter <= 3 || frameCounter % 100 == 0);
-
-    if (shouldLog)
-        DEBUG_LOG("=== Processing FFT Frame #", frameCounter, " ===");
-
-    int hopSize = currentFFTSize / currentOverlapFactor;
-
-    // Copy input to FFT buffers and apply window
-    for (int i = 0; i < currentFFTSize; ++i)
-    {
-        leftFFTData[i] = inputBuffer.getSample(0, i);
-        rightFFTData[i] = inputBuffer.getSample(1, i);
-    }
-
-    if (shouldLog)
-    {
-        float inputMagL = 0.0f, inputMagR = 0.0f;
-        for (int i = 0; i < currentFFTSize; ++i)
-        {
-            inputMagL = std::max(inputMagL, std::abs(leftFFTData[i]));
-            inputMagR = std::max(inputMagR, std::abs(rightFFTData[i]));
-        }
-        DEBUG_LOG("  Pre-FFT input max - L: ", inputMagL, " R: ", inputMagR);
-    }
-
-    // DO NOT window before FFT - we'll window after IFFT for proper COLA
-
-    // Perform FFT
-    fft->performRealOnlyForwardTransform(leftFFTData.data());
-    fft->performRealOnlyForwardTransform(rightFFTData.data());
-
-    if (shouldLog)
-    {
-        DEBUG_LOG("  FFT completed, processing bins...");
-        // Log first few FFT values to understand the format
-        DEBUG_LOG("  Left FFT data[0-10]: ",
-                  leftFFTData[0], " ", leftFFTData[1], " ", leftFFTData[2], " ",
-                  leftFFTData[3], " ", leftFFTData[4], " ", leftFFTData[5]);
-        DEBUG_LOG("  Left FFT data[2040-2047]: ",
-                  leftFFTData[2040], " ", leftFFTData[2041], " ", leftFFTData[2042], " ",
-                  leftFFTData[2043], " ", leftFFTData[2044], " ", leftFFTData[2045], " ",
-                  leftFFTData[2046], " ", leftFFTData[2047]);
-        DEBUG_LOG("  currentFFTSize: ", currentFFTSize);
-    }
-
-    // Process bins: dynamics, delay, feedback, panning
-    int numBins = currentFFTSize / 2;
-    int maxDelayFrames = maxDelaySamples / hopSize;
-    float halfN = currentFFTSize / 2.0f; // normalization factor for dBFS
-
-    // Minimum delay in frames for feedback to be safe (~1ms)
-    int minFeedbackDelayFrames = static_cast<int>((currentSampleRate * 0.001f) / hopSize);
-    if (minFeedbackDelayFrames < 1) minFeedbackDelayFrames = 1;
-
-    // Spectrograph capture buffers
-    bool captureSpectrograph = spectrographEnabled.load();
-    float localSpecL[kMaxSpectrographBins];
-    float localSpecR[kMaxSpectrographBins];
-
-    // ===== PHASE 1: Per-bin feedback + dynamics + spectrograph capture =====
-
-    // Lock bank data while we read curves (protects against message-thread mutations)
-    bool shiftBeforeMult;
-    SkipFlags skipFlags;
-    {
-        juce::SpinLock::ScopedLockType lock(bankLock);
-
-        // Rebuild LUTs for any curves that changed since last frame
-        for (auto& bank : banks)
-            bank.rebuildLUTIfNeeded(numBins, currentSampleRate);
-
-        // Morph weights for per-bin interpolation
-        float mx = getMorphX();
-        float my = getMorphY();
-        float wA = (1.0f - mx) * (1.0f - my);
-        float wB = mx * (1.0f - my);
-        float wC = (1.0f - mx) * my;
-        float wD = mx * my;
-
-        // Shift order: use bank with highest weight
-        float maxW = std::max({wA, wB, wC, wD});
-        shiftBeforeMult = (maxW == wA) ? banks[0].shiftBeforeMultiply :
-                          (maxW == wB) ? banks[1].shiftBeforeMultiply :
-                          (maxW == wC) ? banks[2].shiftBeforeMultiply :
-                                         banks[3].shiftBeforeMultiply;
-
-        // Compute identity-skip flags: skip entire processing phases when all banks are at defaults
-        skipFlags.delay    = true;
-        skipFlags.pan      = true;
-        skipFlags.feedback = true;
-        skipFlags.dynamics = true;
-        skipFlags.shift    = true;
-        for (auto& bank : banks)
-        {
-            if (!bank.delayL.isFlat(0.0f) || !bank.delayR.isFlat(0.0f))
-                skipFlags.delay = false;
-            if (!bank.panL.isFlat(0.0f) || !bank.panR.isFlat(0.0f))
-                skipFlags.pan = false;
-            if (!bank.feedbackL.isFlat(0.0f) || !bank.feedbackR.isFlat(0.0f))
-                skipFlags.feedback = false;
-            if (!bank.preGainL.isFlat(1.0f) || !bank.preGainR.isFlat(1.0f) ||
-                !bank.minGateL.isFlat(0.0f) || !bank.minGateR.isFlat(0.0f) ||
-                !bank.maxClipL.isFlat(1.0f) || !bank.maxClipR.isFlat(1.0f))
-                skipFlags.dynamics = false;
-            if (!bank.shiftL.isFlat(0.5f) || !bank.shiftR.isFlat(0.5f) ||
-                !bank.multiplyL.isFlat(0.5f) || !bank.multiplyR.isFlat(0.5f))
-                skipFlags.shift = false;
-        }
-
-    // Clear feedback buffers when feedback is at identity (ensures clean state on re-enable)
-    if (skipFlags.feedback)
-    {
-        std::memset(feedbackLeftReal.data(), 0, numBins * sizeof(float));
-        std::memset(feedbackLeftImag.data(), 0, numBins * sizeof(float));
-        std::memset(feedbackRightReal.data(), 0, numBins * sizeof(float));
-        std::memset(feedbackRightImag.data(), 0, numBins * sizeof(float));
-    }
-
-    for (int bin = 0; bin < numBins; ++bin)
-    {
-        int realIdx = bin;
-        int imagIdx = numBins + bin;
-
-        float leftReal = leftFFTData[realIdx];
-        float leftImag = (bin == 0 || bin == numBins) ? 0.0f : leftFFTData[imagIdx];
-        float rightReal = rightFFTData[realIdx];
-        float rightImag = (bin == 0 || bin == numBins) ? 0.0f : rightFFTData[imagIdx];
-
-        BinParameters params = evaluateBinParameters(bin, skipFlags, wA, wB, wC, wD);
-        allParams[bin] = params;
-
-        // Add feedback (skip when all banks have feedback at identity)
-        if (!skipFlags.feedback)
-        {
-            leftReal  += feedbackLeftReal[bin];
-            leftImag  += feedbackLeftImag[bin];
-            rightReal += feedbackRightReal[bin];
-            rightImag += feedbackRightImag[bin];
-        }
-
-        // PreGain (skip multiply-by-1 when dynamics at identity)
-        if (!skipFlags.dynamics)
-        {
-            leftReal  *= params.preGainL;
-            leftImag  *= params.preGainL;
-            rightReal *= params.preGainR;
-            rightImag *= params.preGainR;
-
-            // Gate/Clip
-            auto applyGateClip = [halfN](float& real, float& imag, float gateThresh, float clipThresh)
-            {
-                float mag = std::sqrt(real * real + imag * imag);
-                float magNorm = mag / halfN;
-                if (magNorm < gateThresh)
-                {
-                    real = 0.0f;
-                    imag = 0.0f;
-                }
-                else if (magNorm > clipThresh && mag > 0.0f)
-                {
-                    float scale = (clipThresh * halfN) / mag;
-                    real *= scale;
-                    imag *= scale;
-                }
-            };
-            applyGateClip(leftReal, leftImag, params.minGateL, params.maxClipL);
-            applyGateClip(rightReal, rightImag, params.minGateR, params.maxClipR);
-        }
-
-        // Spectrograph capture
-        if (captureSpectrograph && bin < kMaxSpectrographBins)
-        {
-            float magL = std::sqrt(leftReal * leftReal + leftImag * leftImag);
-            float magR = std::sqrt(rightReal * rightReal + rightImag * rightImag);
-            float magLNorm = magL / halfN;
-            float magRNorm = magR / halfN;
-            localSpecL[bin] = (magLNorm > 0.0f) ? std::max(-60.0f, 20.0f * std::log10(magLNorm)) : -60.0f;
-            localSpecR[bin] = (magRNorm > 0.0f) ? std::max(-60.0f, 20.0f * std::log10(magRNorm)) : -60.0f;
-        }
-
-        tempLeftReal[bin] = leftReal;
-        tempLeftImag[bin] = leftImag;
-        tempRightReal[bin] = rightReal;
-        tempRightImag[bin] = rightImag;
-    }
-    } // bankLock released — all bank curve data is now in temp arrays
-
-    // ===== PHASE 2: Spectral shift/multiply (forward scatter) =====
-    if (skipFlags.shift)
-    {
-        // Identity: no shift or multiply — direct copy instead of scatter
-        std::memcpy(shiftedLeftReal.data(), tempLeftReal.data(), numBins * sizeof(float));
-        std::memcpy(shiftedLeftImag.data(), tempLeftImag.data(), numBins * sizeof(float));
-        std::memcpy(shiftedRightReal.data(), tempRightReal.data(), numBins * sizeof(float));
-        std::memcpy(shiftedRightImag.data(), tempRightImag.data(), numBins * sizeof(float));
-    }
-    else
-    {
-    // Zero the shifted arrays before scatter accumulation
-    std::memset(shiftedLeftReal.data(), 0, numBins * sizeof(float));
-    std::memset(shiftedLeftImag.data(), 0, numBins * sizeof(float));
-    std::memset(shiftedRightReal.data(), 0, numBins * sizeof(float));
-    std::memset(shiftedRightImag.data(), 0, numBins * sizeof(float));
-
-    float binFreqStep = static_cast<float>(currentSampleRate) / static_cast<float>(currentFFTSize);
-
-    for (int bin = 0; bin < numBins; ++bin)
-    {
-        float binFreq = bin * binFreqStep;
-        auto& params = allParams[bin];
-
-        // Fixed absolute formulas (display ranges are zoom-only, don't affect audio)
-        // Shift: Y=0 → -10000Hz, Y=0.5 → 0Hz, Y=1 → +10000Hz
-        float shiftHzL = (params.shiftL - 0.5f) * 20000.0f;
-        float shiftHzR = (params.shiftR - 0.5f) * 20000.0f;
-
-        // Multiply: Y=0 → 0.1x, Y=0.5 → 1.0x, Y=1 → 10.0x (logarithmic)
-        float multFactorL = 0.1f * std::pow(100.0f, params.multiplyL);
-        float multFactorR = 0.1f * std::pow(100.0f, params.multiplyR);
-
-        // Compute target frequency based on application order
-        float targetFreqL, targetFreqR;
-        if (shiftBeforeMult)
-        {
-            targetFreqL = (binFreq + shiftHzL) * multFactorL;
-            targetFreqR = (binFreq + shiftHzR) * multFactorR;
-        }
-        else
-        {
-            targetFreqL = binFreq * multFactorL + shiftHzL;
-            targetFreqR = binFreq * multFactorR + shiftHzR;
-        }
-
-        // Convert target frequency back to bin index (fractional)
-        float targetBinL = targetFreqL / binFreqStep;
-        float targetBinR = targetFreqR / binFreqStep;
-
-        // Forward scatter with linear interpolation (left channel)
-        if (targetBinL >= 0.0f && targetBinL < numBins - 1)
-        {
-            int lo = static_cast<int>(targetBinL);
-            float frac = targetBinL - lo;
-            int hi = lo + 1;
-            if (lo >= 0 && hi < numBins)
-            {
-                shiftedLeftReal[lo] += tempLeftReal[bin] * (1.0f - frac);
-                shiftedLeftImag[lo] += tempLeftImag[bin] * (1.0f - frac);
-                shiftedLeftReal[hi] += tempLeftReal[bin] * frac;
-                shiftedLeftImag[hi] += tempLeftImag[bin] * frac;
-            }
-            else if (lo >= 0 && lo < numBins)
-            {
-                shiftedLeftReal[lo] += tempLeftReal[bin];
-                shiftedLeftImag[lo] += tempLeftImag[bin];
-            }
-        }
-        else if (targetBinL >= 0.0f && targetBinL < numBins)
-        {
-            int idx = static_cast<int>(targetBinL);
-            shiftedLeftReal[idx] += tempLeftReal[bin];
-            shiftedLeftImag[idx] += tempLeftImag[bin];
-        }
-
-        // Forward scatter (right channel)
-        if (targetBinR >= 0.0f && targetBinR < numBins - 1)
-        {
-            int lo = static_cast<int>(targetBinR);
-            float frac = targetBinR - lo;
-            int hi = lo + 1;
-            if (lo >= 0 && hi < numBins)
-            {
-                shiftedRightReal[lo] += tempRightReal[bin] * (1.0f - frac);
-                shiftedRightImag[lo] += tempRightImag[bin] * (1.0f - frac);
-                shiftedRightReal[hi] += tempRightReal[bin] * frac;
-                shiftedRightImag[hi] += tempRightImag[bin] * frac;
-            }
-            else if (lo >= 0 && lo < numBins)
-            {
-                shiftedRightReal[lo] += tempRightReal[bin];
-                shiftedRightImag[lo] += tempRightImag[bin];
-            }
-        }
-        else if (targetBinR >= 0.0f && targetBinR < numBins)
-        {
-            int idx = static_cast<int>(targetBinR);
-            shiftedRightReal[idx] += tempRightReal[bin];
-            shiftedRightImag[idx] += tempRightImag[bin];
-        }
-    }
-    } // end else (shift not skipped)
-
-    // ===== PHASE 3: Per-bin delay + pan + feedback store from shifted arrays =====
-    for (int bin = 0; bin < numBins; ++bin)
-    {
-        int realIdx = bin;
-        int imagIdx = numBins + bin;
-
-        float leftReal = shiftedLeftReal[bin];
-        float leftImag = shiftedLeftImag[bin];
-        float rightReal = shiftedRightReal[bin];
-        float rightImag = shiftedRightImag[bin];
-
-        auto& params = allParams[bin];
-
-        // Delay (skip entirely when all delay curves are at identity)
-        float delayedLeftReal, delayedLeftImag, delayedRightReal, delayedRightImag;
-        int delayL = 0, delayR = 0;
-
-        if (!skipFlags.delay)
-        {
-            int delayL_samples = static_cast<int>(params.delayL);
-            int delayR_samples = static_cast<int>(params.delayR);
-            delayL = delayL_samples / hopSize;
-            delayR = delayR_samples / hopSize;
-            delayL = std::clamp(delayL, 0, maxDelayFrames - 1);
-            delayR = std::clamp(delayR, 0, maxDelayFrames - 1);
-
-            if (delayL > 0)
-            {
-                int& wp = leftBinDelayWritePos[bin];
-                leftBinDelayBuffers[bin].setSample(0, wp, leftReal);
-                leftBinDelayBuffers[bin].setSample(1, wp, leftImag);
-                int rp = (wp - delayL + maxDelayFrames) % maxDelayFrames;
-                delayedLeftReal = leftBinDelayBuffers[bin].getSample(0, rp);
-                delayedLeftImag = leftBinDelayBuffers[bin].getSample(1, rp);
-                wp = (wp + 1) % maxDelayFrames;
-            }
-            else
-            {
-                delayedLeftReal = leftReal;
-                delayedLeftImag = leftImag;
-            }
-
-            if (delayR > 0)
-            {
-                int& wp = rightBinDelayWritePos[bin];
-                rightBinDelayBuffers[bin].setSample(0, wp, rightReal);
-                rightBinDelayBuffers[bin].setSample(1, wp, rightImag);
-                int rp = (wp - delayR + maxDelayFrames) % maxDelayFrames;
-                delayedRightReal = rightBinDelayBuffers[bin].getSample(0, rp);
-                delayedRightImag = rightBinDelayBuffers[bin].getSample(1, rp);
-                wp = (wp + 1) % maxDelayFrames;
-            }
-            else
-            {
-                delayedRightReal = rightReal;
-                delayedRightImag = rightImag;
-            }
-        }
-        else
-        {
-            delayedLeftReal = leftReal;
-            delayedLeftImag = leftImag;
-            delayedRightReal = rightReal;
-            delayedRightImag = rightImag;
-        }
-
-        // Pan crossfeed (skip trig when all pan curves are at identity)
-        float outputLeftReal, outputLeftImag, outputRightReal, outputRightImag;
-
-        if (!skipFlags.pan)
-        {
-            float panL = params.panL;
-            float panR = params.panR;
-            float leftToLeft   = std::cos(panL * M_PI * 0.5f);
-            float leftToRight  = std::sin(panL * M_PI * 0.5f);
-            float rightToRight = std::cos(panR * M_PI * 0.5f);
-            float rightToLeft  = std::sin(panR * M_PI * 0.5f);
-
-            outputLeftReal  = delayedLeftReal * leftToLeft + delayedRightReal * rightToLeft;
-            outputLeftImag  = delayedLeftImag * leftToLeft + delayedRightImag * rightToLeft;
-            outputRightReal = delayedRightReal * rightToRight + delayedLeftReal * leftToRight;
-            outputRightImag = delayedRightImag * rightToRight + delayedLeftImag * leftToRight;
-        }
-        else
-        {
-            outputLeftReal  = delayedLeftReal;
-            outputLeftImag  = delayedLeftImag;
-            outputRightReal = delayedRightReal;
-            outputRightImag = delayedRightImag;
-        }
-
-        // Feedback store (skip when all feedback curves are at identity)
-        if (!skipFlags.feedback)
-        {
-            float fbL = (delayL >= minFeedbackDelayFrames) ? params.feedbackL : 0.0f;
-            float fbR = (delayR >= minFeedbackDelayFrames) ? params.feedbackR : 0.0f;
-
-            feedbackLeftReal[bin]  = outputLeftReal * fbL;
-            feedbackLeftImag[bin]  = outputLeftImag * fbL;
-            feedbackRightReal[bin] = outputRightReal * fbR;
-            feedbackRightImag[bin] = outputRightImag * fbR;
-
-            auto sanitize = [](float& v) { if (!std::isfinite(v)) v = 0.0f; };
-            sanitize(feedbackLeftReal[bin]);
-            sanitize(feedbackLeftImag[bin]);
-            sanitize(feedbackRightReal[bin]);
-            sanitize(feedbackRightImag[bin]);
-        }
-
-        // Write to output FFT buffer
-        leftFFTData[realIdx] = outputLeftReal;
-        if (bin != 0 && bin != numBins)
-            leftFFTData[imagIdx] = outputLeftImag;
-
-        rightFFTData[realIdx] = outputRightReal;
-        if (bin != 0 && bin != numBins)
-            rightFFTData[imagIdx] = outputRightImag;
-    }
-
-    // Write spectrograph data under lock
-    if (captureSpectrograph)
-    {
-        if (spectrographLock.tryEnter())
-        {
-            spectrographNumBins = std::min(numBins, kMaxSpectrographBins);
-            std::memcpy(spectrographDataL, localSpecL, spectrographNumBins * sizeof(float));
-            std::memcpy(spectrographDataR, localSpecR, spectrographNumBins * sizeof(float));
-            spectrographLock.exit();
-        }
-    }
-
-    if (shouldLog)
-        DEBUG_LOG("  Bin processing completed, performing IFFT...");
-
-    // Perform IFFT
-    fft->performRealOnlyInverseTransform(leftFFTData.data());
-    fft->performRealOnlyInverseTransform(rightFFTData.data());
-
-    // Apply Hann window AFTER IFFT (synthesis window)
-    window->multiplyWithWindowingTable(leftFFTData.data(), currentFFTSize);
-    window->multiplyWithWindowingTable(rightFFTData.data(), currentFFTSize);
-
-    // Overlap-add to output buffer
-    // Empirically determined scale factor for unity gain with:
-    // - Hann window applied after IFFT
-    // - 4x overlap (75%)
-    // - JUCE FFT (which doesn't normalize)
-    // 0.21 was -1.5dB, so multiply by 1.189 to get unity gain
-    float scaleFactor = 0.25f;
-
-    if (shouldLog)
-        DEBUG_LOG("  Using scale factor: ", scaleFactor);
-
-    if (shouldLog)
-    {
-        float outputMagL = 0.0f, outputMagR = 0.0f;
-        for (int i = 0; i < currentFFTSize; ++i)
-        {
-            outputMagL = std::max(outputMagL, std::abs(leftFFTData[i] * scaleFactor));
-            outputMagR = std::max(outputMagR, std::abs(rightFFTData[i] * scaleFactor));
-        }
-        DEBUG_LOG("  Post-IFFT output max - L: ", outputMagL, " R: ", outputMagR);
-    }
-
-    // Overlap-add to output buffer (gain and clip are applied later in processBlock
-    // after all overlapping frames are summed, so they work on the final signal)
-    for (int i = 0; i < currentFFTSize; ++i)
-    {
-        float sL = leftFFTData[i] * scaleFactor;
-        float sR = rightFFTData[i] * scaleFactor;
-
-        int outputPos = (outputBufferWritePos + i) % outputBuffer.getNumSamples();
-        outputBuffer.setSample(0, outputPos, outputBuffer.getSample(0, outputPos) + sL);
-        outputBuffer.setSample(1, outputPos, outputBuffer.getSample(1, outputPos) + sR);
-    }
-
-    // Advance write position by hop size
-    outputBufferWritePos = (outputBufferWritePos + hopSize) % outputBuffer.getNumSamples();
-
-    if (shouldLog)
-        DEBUG_LOG("=== FFT Frame #", frameCounter, " completed ===");
-}
-
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new SpectrasaurusAudioProcessor();
@@ -3,9 +3,16 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include "Bank.h"
+#include "BankSnapshot.h"
+#include "FrameWorkerPool.h"
+#include "MultiResolutionEngine.h"
+#include "OutputStage.h"
+#include "SpectralKernels.h"
 #include <array>
+#include <memory>
 
-class SpectrasaurusAudioProcessor : public juce::AudioProcessor
+class SpectrasaurusAudioProcessor : public juce::AudioProcessor,
+                                    private juce::Timer
 {
 public:
     SpectrasaurusAudioProcessor();
@@ -37,8 +44,21 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
-    // Banks
-    std::array<Bank, 4> banks; // A, B, C, D
+    // Banks (A, B, C, D) as edited. Message thread only: the audio thread works
+    // from immutable snapshots, so call publishBanks() after changing them.
+    std::array<Bank, 4> banks;
+
+    // Hand the audio thread a snapshot of `banks`. Never blocks the audio thread,
+    // which picks it up at the start of a block once its curve tables are compiled.
+    void publishBanks();
+
+    // Publish only if `banks` differs from the last snapshot (polled by the editor
+    // to pick up curve edits made directly in the snap windows)
+    void publishBanksIfChanged();
+
+    // Audio thread (and engines running on it): the banks currently in effect
+    const BankSnapshot& getActiveBankSnapshot() const { return *activeBankSnapshot.load(); }
+    const std::array<Bank, 4>& getActiveBanks() const { return getActiveBankSnapshot().banks; }
 
     // Active bank for editing (0=A, 1=B, 2=C, 3=D)
     std::atomic<int> activeBankIndex { 0 };
@@ -81,102 +101,146 @@ public:
     MultZoomRange multLZoom;
     MultZoomRange multRZoom;
 
-    // Reallocate delay buffers if any bank's max delay exceeds current capacity.
-    // Safe to call from the message thread — uses suspendProcessing().
-    void reallocateDelayBuffersIfNeeded();
+    // STFT settings for every bank
+    struct FFTSettings
+    {
+        int fftSize = 2048;
+        int overlapFactor = 4;
+        STFTWindow window = STFTWindow::SynthesisHann;
+        int numBands = 1; // 1 = single STFT, 2-3 = band split (see MultiResolutionEngine)
+    };
 
-    // Lock protecting bank data from concurrent audio-thread reads and message-thread writes.
-    // The audio thread acquires this in processFFTFrame; the message thread acquires it
-    // around bulk bank mutations (paste, reset, copy L<->R, preset load).
-    juce::SpinLock bankLock;
+    // Takes effect without interrupting audio: a new engine is built in the background
+    // and crossfaded in once it has warmed up. Invalid settings are ignored.
+    // Call from the message thread.
+    void setFFTSettings(const FFTSettings& settings);
+    FFTSettings getFFTSettings() const;
+    static juce::Array<int> getAvailableFFTSizes();
+    static juce::Array<int> getAvailableOverlapFactors();
+
+    // Store the spectral delay lines as 16-bit floats: half the memory (and memory
+    // traffic) of long delays, with about -66 dB of error on each delayed bin (see
+    // BinDelayArena). Applied like setFFTSettings. Initialised from the
+    // SPECTRASAURUS_DELAY_PRECISION environment variable (half / float) when set.
+    void setHalfPrecisionDelays(bool shouldUseHalfPrecision);
+    bool getHalfPrecisionDelays() const;
+
+    // Grow the delay capacity if any bank's max delay exceeds it. Larger delay
+    // lines are built in the background and swapped in without interrupting audio
+    // or the echoes already sounding. Call from the message thread.
+    void reallocateDelayBuffersIfNeeded();
 
     // Spectrograph data (post-dynamics bin magnitudes in dB, -60 to 0)
-    static constexpr int kMaxSpectrographBins = 1024;
+    static constexpr int kMaxSpectrographBins = 4096; // largest FFT size / 2
     juce::SpinLock spectrographLock;
     float spectrographDataL[kMaxSpectrographBins] = {};
     float spectrographDataR[kMaxSpectrographBins] = {};
     int spectrographNumBins = 0;
     std::atomic<bool> spectrographEnabled { false };
 
-private:
-    // Simplified FFT processing
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
-
-    juce::AudioBuffer<float> inputBuffer;
-    juce::AudioBuffer<float> outputBuffer;
-    juce::AudioBuffer<float> fftBuffer;
-
-    int inputBufferWritePos = 0;
-    int outputBufferReadPos = 0;
-    int outputBufferWritePos = 0;
-
-    std::vector<float> leftFFTData;
-    std::vector<float> rightFFTData;
+    // Per-bin kernel instruction set. Auto picks the best path for this CPU; the
+    // others force a specific path (falling back if unsupported) so each can be
+    // tested. Initialised from the SPECTRASAURUS_KERNEL_ISA environment variable
+    // (scalar / sse2 / avx2 / avx512) when set.
+    std::atomic<KernelIsa> forcedKernelIsa { KernelIsa::Auto };
 
-    // Per-bin delay buffers
-    std::vector<juce::AudioBuffer<float>> leftBinDelayBuffers;
-    std::vector<juce::AudioBuffer<float>> rightBinDelayBuffers;
-    std::vector<int> leftBinDelayWritePos;
-    std::vector<int> rightBinDelayWritePos;
+    // Transform both channels with one packed complex FFT per direction instead of
+    // two real FFTs each (see StereoFFT). Off runs the separate real transforms.
+    std::atomic<bool> packedStereoFFT { true };
 
-    // Per-bin feedback buffers (real + imag per bin, per channel)
-    std::vector<float> feedbackLeftReal;
-    std::vector<float> feedbackLeftImag;
-    std::vector<float> feedbackRightReal;
-    std::vector<float> feedbackRightImag;
+    // Helper threads that large FFT frames (4096 points and up) split their per-bin
+    // work across. One pool serves every instance in the process, so a session full
+    // of instances spreads its frames over the cores instead of queueing on the
+    // host's audio threads. Off runs every frame on the audio thread alone.
+    std::shared_ptr<FrameWorkerPool> frameWorkers;
+    std::atomic<bool> parallelFrames { true };
 
-    void processFFTFrame();
+    // Audio thread: the engine's delay lines are too short for the active banks'
+    // delay curves. Builds lines sized for them in the background.
+    void requestDelayResize() { delayResizeRequested = true; }
 
-    // Per-instance debug counters (not static — avoids cross-instance data races)
+private:
+    // Engine handoff. The audio thread owns `engine` (and `fadingEngine` while a
+    // crossfade runs); new engines arrive through `pendingEngine`, built by
+    // engineBuilder, and old ones leave through `retiredEngine` to be freed there.
+    class EngineBuildThread;
+    std::unique_ptr<EngineBuildThread> engineBuilder;
+    juce::CriticalSection builderLock; // held by engineBuilder while it works, and by prepareToPlay doing that work itself
+
+    juce::CriticalSection engineConfigLock;
+    MultiResolutionEngine::Config engineConfig;    // what the engine should be (under engineConfigLock)
+    MultiResolutionEngine::Config publishedConfig; // last engine built or handed over (under engineConfigLock)
+    std::atomic<bool> engineRebuildRequested { false };
+    std::atomic<bool> delayResizeRequested { false }; // new delay lines for the running engine
+
+    std::unique_ptr<MultiResolutionEngine> engine;
+    std::unique_ptr<MultiResolutionEngine> fadingEngine;
+    std::atomic<MultiResolutionEngine*> pendingEngine { nullptr };
+    std::atomic<MultiResolutionEngine*> retiredEngine { nullptr };
+
+    // A new engine runs silently until its STFT has filled, then fades in
+    int engineWarmupRemaining = 0;
+    int engineCrossfadePos = 0;
+    int engineCrossfadeLength = 1;
+
+    juce::AudioBuffer<float> wetBuffer;  // current engine output for one sub-block
+    juce::AudioBuffer<float> fadeBuffer; // fading engine output for one sub-block
+    OutputStage outputStage;             // set up per block in processBlock
+
+    std::atomic<int> engineLatency { 0 };
+    std::atomic<bool> engineLatencyChanged { false }; // set by the audio thread, polled by timerCallback
+
+    // Tail reported to the host: the engine's overlap-add (its warmup), then the
+    // echoes of the banks last compiled
+    std::atomic<int> engineWarmupSamples { 0 };
+    std::atomic<double> echoTailSeconds { 0.0 };
+
+    // Idle: after the input has been silent long enough for the engine to decay,
+    // blocks skip it (wet = silence) until input returns
+    int quietSamples = 0;
+    bool engineIdle = false;
+
+    // Delay line handoff: engineBuilder builds lines for the running engine's
+    // configuration into pendingDelayLines, and the audio thread moves the engine
+    // onto them. The lines they replace stay in replacedDelayLines while that
+    // engine still reads echoes from them, then go to retiredDelayLines to be freed.
+    std::atomic<MultiResolutionEngine::DelayLineSet*> pendingDelayLines { nullptr };
+    std::atomic<MultiResolutionEngine::DelayLineSet*> retiredDelayLines { nullptr };
+    std::unique_ptr<MultiResolutionEngine::DelayLineSet> replacedDelayLines;
+    const MultiResolutionEngine* replacedDelayLinesReader = nullptr;
+
+    // Bank snapshot handoff, like the engines': publishBanks() queues a snapshot,
+    // engineBuilder compiles its curve tables and moves it to pendingBankSnapshot,
+    // the audio thread swaps it in at the start of a block and passes the one it
+    // replaces to retiredBankSnapshot, which engineBuilder frees
+    std::atomic<BankSnapshot*> queuedBankSnapshot { nullptr };
+    std::atomic<BankSnapshot*> pendingBankSnapshot { nullptr };
+    std::atomic<BankSnapshot*> activeBankSnapshot { nullptr };
+    std::atomic<BankSnapshot*> retiredBankSnapshot { nullptr };
+    std::array<Bank, 4> publishedBanks; // what the last snapshot was built from (message thread)
+
+    // Curve tables are compiled for the engine layouts of engineConfig. When those
+    // change, the builder recompiles the latest banks (compiledBanks, builder thread only).
+    std::atomic<bool> bankRecompileRequested { false };
+    std::array<Bank, 4> compiledBanks;
+    juce::WaitableEvent curveCompileDone; // signalled by the last helper to finish (outlives the pool)
+    juce::ThreadPool curveCompilePool;
+
+    void compileQueuedBanks();
+    void swapInPendingBanks();
+
+    void buildPendingEngine();
+    void swapInPendingEngine();
+    void buildPendingDelayLines();
+    void swapInPendingDelayLines();
+    int computeMaxDelaySamples(double sampleRate) const;
+
+    // Reports engineLatency to the host from the message thread once the audio
+    // thread has flagged it (posting a message from there could lock or allocate)
+    void timerCallback() override;
+
+    // Per-instance debug counter (not static — avoids cross-instance data races)
     int blockCounter = 0;
-    int frameCounter = 0;
-
-    double currentSampleRate = 48000.0;
-    int currentFFTSize = 2048;
-    int currentOverlapFactor = 4;
-    int maxDelaySamples = 48000; // computed from bank settings
-
-    void updateFFTSettings();
-
-    // Morphing and evaluation
-    struct BinParameters
-    {
-        float delayL;
-        float delayR;
-        float panL;
-        float panR;
-        float feedbackL;         // Linear gain 0-~2
-        float feedbackR;         // Linear gain 0-~2
-        // Dynamics (linear values)
-        float preGainL;          // Linear gain (0 to 1)
-        float preGainR;
-        float minGateL;          // Linear threshold
-        float minGateR;
-        float maxClipL;          // Linear threshold
-        float maxClipR;
-        // Spectral shift (normalized 0-1 curve values)
-        float shiftL;            // normalized Y from shift curve
-        float shiftR;
-        float multiplyL;         // normalized Y from multiply curve
-        float multiplyR;
-    };
-
-    struct SkipFlags {
-        bool delay = false;
-        bool pan = false;
-        bool feedback = false;
-        bool dynamics = false;
-        bool shift = false;
-    };
-
-    // Pre-allocated working buffers for processFFTFrame (avoid heap alloc on audio thread)
-    std::vector<float> tempLeftReal, tempLeftImag, tempRightReal, tempRightImag;
-    std::vector<float> shiftedLeftReal, shiftedLeftImag, shiftedRightReal, shiftedRightImag;
-    std::vector<BinParameters> allParams;
-
-    BinParameters evaluateBinParameters(int binIndex, const SkipFlags& skip,
-                                        float wA, float wB, float wC, float wD);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrasaurusAudioProcessor)
 };
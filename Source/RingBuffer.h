@@ -0,0 +1,89 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// Multi-channel circular sample buffer with a power-of-two capacity.
+// Positions are plain ints that wrap with a mask, and every transfer is split
+// into at most two contiguous spans so callers can use block copies instead of
+// per-sample get/set with modulo indexing.
+class RingBuffer
+{
+public:
+    RingBuffer() = default;
+
+    // Allocates (and clears) at least minCapacity samples per channel, rounded up to a power of two
+    void setSize(int numChannels, int minCapacity)
+    {
+        capacity = juce::nextPowerOfTwo(std::max(minCapacity, 1));
+        mask = capacity - 1;
+        data.setSize(numChannels, capacity);
+        data.clear();
+    }
+
+    void clear() { data.clear(); }
+
+    int getNumChannels() const { return data.getNumChannels(); }
+    int getCapacity() const { return capacity; }
+    int wrap(int pos) const { return pos & mask; }
+
+    // Calls fn(ringIndex, spanOffset, spanLength) for the (up to two) contiguous
+    // spans covering [pos, pos + num) in ring order
+    template <typename Fn>
+    void forEachSpan(int pos, int num, Fn&& fn) const
+    {
+        pos = wrap(pos);
+        int first = std::min(num, capacity - pos);
+        if (first > 0)
+            fn(pos, 0, first);
+        if (num > first)
+            fn(0, first, num - first);
+    }
+
+    // Copy num samples from src into the ring starting at pos
+    void write(int channel, int pos, const float* src, int num)
+    {
+        float* ring = data.getWritePointer(channel);
+        forEachSpan(pos, num, [&](int ringIdx, int offset, int len)
+        {
+            std::memcpy(ring + ringIdx, src + offset, static_cast<size_t>(len) * sizeof(float));
+        });
+    }
+
+    // Copy num samples starting at pos out of the ring into dest
+    void read(int channel, int pos, float* dest, int num) const
+    {
+        const float* ring = data.getReadPointer(channel);
+        forEachSpan(pos, num, [&](int ringIdx, int offset, int len)
+        {
+            std::memcpy(dest + offset, ring + ringIdx, static_cast<size_t>(len) * sizeof(float));
+        });
+    }
+
+    // ring[pos + i] += src[i] * gain[i] — fused synthesis-window + overlap-add
+    void addWithMultiply(int channel, int pos, const float* src, const float* gain, int num)
+    {
+        float* ring = data.getWritePointer(channel);
+        forEachSpan(pos, num, [&](int ringIdx, int offset, int len)
+        {
+            juce::FloatVectorOperations::addWithMultiply(ring + ringIdx, src + offset, gain + offset, len);
+        });
+    }
+
+    // Zero num samples starting at pos
+    void clear(int channel, int pos, int num)
+    {
+        float* ring = data.getWritePointer(channel);
+        forEachSpan(pos, num, [&](int ringIdx, int, int len)
+        {
+            juce::FloatVectorOperations::clear(ring + ringIdx, len);
+        });
+    }
+
+    const float* getReadPointer(int channel) const { return data.getReadPointer(channel); }
+    float* getWritePointer(int channel) { return data.getWritePointer(channel); }
+
+private:
+    juce::AudioBuffer<float> data;
+    int capacity = 0;
+    int mask = 0;
+};
@@ -0,0 +1,139 @@
+#include "STFTWindows.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace
+{
+// Periodic windows (period fftSize rather than fftSize - 1) so overlapped
+// copies sum flat at the hop sizes we use
+void fillHann(std::vector<float>& w)
+{
+    const double n = static_cast<double>(w.size());
+    for (size_t i = 0; i < w.size(); ++i)
+        w[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * juce::MathConstants<double>::pi * i / n));
+}
+
+void fillBlackmanHarris(std::vector<float>& w)
+{
+    const double n = static_cast<double>(w.size());
+    for (size_t i = 0; i < w.size(); ++i)
+    {
+        double x = 2.0 * juce::MathConstants<double>::pi * i / n;
+        w[i] = static_cast<float>(0.35875 - 0.48829 * std::cos(x)
+                                  + 0.14128 * std::cos(2.0 * x) - 0.01168 * std::cos(3.0 * x));
+    }
+}
+// Asymmetric analysis/synthesis pair: sqrt-Hann rise over fftSize - hop samples,
+// sqrt-Hann fall over the last hop; synthesis turns the product into a Hann of
+// length 2 * hop over the last two hops, which overlap-adds flat at that hop
+void fillLowLatency(std::vector<float>& analysis, std::vector<float>& synthesis, int hopSize)
+{
+    const int n = static_cast<int>(analysis.size());
+    const int riseLength = n - hopSize;
+    const int tailStart = n - 2 * hopSize;
+    const double pi = juce::MathConstants<double>::pi;
+
+    for (int i = 0; i < n; ++i)
+    {
+        double hann = i < riseLength ? 0.5 - 0.5 * std::cos(pi * i / riseLength)
+                                     : 0.5 - 0.5 * std::cos(pi * (i - tailStart) / hopSize);
+        analysis[i] = static_cast<float>(std::sqrt(hann));
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (i < tailStart || analysis[i] <= 0.0f)
+        {
+            synthesis[i] = 0.0f;
+            continue;
+        }
+        double product = 0.5 - 0.5 * std::cos(pi * (i - tailStart) / hopSize);
+        synthesis[i] = static_cast<float>(product / analysis[i]);
+    }
+}
+
+std::mutex sharedPairsMutex;
+std::map<std::tuple<int, int, int>, std::weak_ptr<const STFTWindowPair>> sharedPairs; // (type, size, hop)
+} // namespace
+
+juce::StringArray STFTWindowPair::getWindowNames()
+{
+    return { "Hann (synthesis)", "Sqrt-Hann", "Hann", "Blackman-Harris", "Low latency" };
+}
+
+void STFTWindowPair::prepare(STFTWindow type, int fftSize, int hopSize)
+{
+    const auto size = static_cast<size_t>(fftSize);
+    std::vector<float> shape(size);
+
+    synthesisStart = 0;
+
+    if (type == STFTWindow::LowLatency)
+    {
+        analysis.assign(size, 0.0f);
+        synthesis.assign(size, 0.0f);
+        fillLowLatency(analysis, synthesis, hopSize);
+        synthesisStart = fftSize - 2 * hopSize;
+    }
+    else
+    {
+        if (type == STFTWindow::BlackmanHarris)
+            fillBlackmanHarris(shape);
+        else
+            fillHann(shape);
+
+        if (type == STFTWindow::SqrtHann)
+            for (auto& v : shape)
+                v = std::sqrt(v);
+
+        synthesis = shape;
+        if (type == STFTWindow::SynthesisHann)
+            analysis.clear();
+        else
+            analysis = shape;
+    }
+
+    if (!analysis.empty())
+    {
+        double sum = 0.0;
+        for (float v : analysis)
+            sum += v;
+
+        // Unit mean; the synthesis normalization below absorbs the scale
+        for (auto& v : analysis)
+            v = static_cast<float>(v * fftSize / sum);
+    }
+
+    // Overlap-added analysis*synthesis over one hop period
+    std::vector<double> olaSum(static_cast<size_t>(hopSize), 0.0);
+    for (int i = 0; i < fftSize; ++i)
+        olaSum[static_cast<size_t>(i % hopSize)] += synthesis[i] * (analysis.empty() ? 1.0 : analysis[i]);
+
+    for (int i = 0; i < fftSize; ++i)
+    {
+        double s = olaSum[static_cast<size_t>(i % hopSize)];
+        synthesis[i] = s > 1.0e-9 ? static_cast<float>(synthesis[i] / s) : 0.0f;
+    }
+}
+
+std::shared_ptr<const STFTWindowPair> STFTWindowPair::getShared(STFTWindow type, int fftSize, int hopSize)
+{
+    std::lock_guard<std::mutex> lock(sharedPairsMutex);
+
+    // Forget pairs nobody uses any more
+    for (auto it = sharedPairs.begin(); it != sharedPairs.end();)
+        it = it->second.expired() ? sharedPairs.erase(it) : std::next(it);
+
+    auto& entry = sharedPairs[std::make_tuple(static_cast<int>(type), fftSize, hopSize)];
+    auto pair = entry.lock();
+    if (pair == nullptr)
+    {
+        auto built = std::make_shared<STFTWindowPair>();
+        built->prepare(type, fftSize, hopSize);
+        pair = built;
+        entry = pair;
+    }
+    return pair;
+}
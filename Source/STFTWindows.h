@@ -0,0 +1,48 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+
+// Analysis/synthesis window pairs for the STFT. Stored as ints in state and presets,
+// so only ever append.
+enum class STFTWindow
+{
+    SynthesisHann = 0,  // no analysis window, Hann on synthesis (the original behaviour)
+    SqrtHann = 1,       // sqrt-Hann on both sides, perfect reconstruction from 2x overlap
+    Hann = 2,           // Hann on both sides, lowest leakage/ripple from 4x overlap
+    BlackmanHarris = 3, // 4-term Blackman-Harris on both sides, for 4x/8x overlap
+    LowLatency = 4      // asymmetric pair, latency of two hops instead of the FFT size
+};
+
+// Both windows of a pair for one FFT size and hop. Engines take theirs from
+// getShared(), so every engine in the process with the same settings reads one copy.
+//
+// The analysis window is scaled to unit mean so bin magnitudes (and therefore
+// the gate/clip thresholds and the spectrograph) read the same as with no window.
+// The synthesis window has the overlap-add normalization folded in: it is divided
+// by the overlap-added analysis*synthesis product, so unprocessed audio comes back
+// at unity gain for any window pair and hop (weighted overlap-add).
+//
+// LowLatency keeps the full FFT length for analysis, but the analysis window rises
+// over most of the frame and falls over the last hop only, and the synthesis window
+// covers just the last two hops. Each frame then only produces output for its newest
+// two hops, so latency drops from fftSize to 2 * hopSize with the same resolution.
+struct STFTWindowPair
+{
+    std::vector<float> analysis;  // empty for SynthesisHann (no analysis pass needed)
+    std::vector<float> synthesis;
+    int synthesisStart = 0;       // synthesis is zero before this sample
+
+    // Input-to-output delay of the overlap-add
+    int getLatencySamples() const { return static_cast<int>(synthesis.size()) - synthesisStart; }
+
+    void prepare(STFTWindow type, int fftSize, int hopSize);
+
+    // The process-wide pair for these settings, built by the first caller and freed
+    // with the last reference. Not real-time safe.
+    static std::shared_ptr<const STFTWindowPair> getShared(STFTWindow type, int fftSize, int hopSize);
+
+    static juce::StringArray getWindowNames(); // indexed by STFTWindow
+    static bool isValid(int type) { return type >= 0 && type <= static_cast<int>(STFTWindow::LowLatency); }
+};
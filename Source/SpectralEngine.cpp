@@ -0,0 +1,1224 @@
+#include "SpectralEngine.h"
+#include "PluginProcessor.h"
+#include "DebugLogger.h"
+#include "FastMath.h"
+#include <cstring>
+#include <limits>
+
+SpectralEngine::SpectralEngine(SpectrasaurusAudioProcessor& ownerProcessor, const Config& engineConfig)
+    : owner(ownerProcessor), config(engineConfig)
+{
+    DEBUG_LOG("Building spectral engine - FFT size: ", config.fftSize,
+              " overlap: ", config.overlapFactor, " window: ", static_cast<int>(config.window),
+              " sample rate: ", config.sampleRate, " channels: ", config.numChannels);
+
+    windows = STFTWindowPair::getShared(config.window, config.fftSize, getHopSize());
+
+    // Allocate rings - output needs to be larger for overlap-add
+    const int numPairs = juce::jlimit(1, kMaxChannels, config.numPairs);
+    inputBuffer.setSize(2 * numPairs, config.fftSize);
+    outputBuffer.setSize(2 * numPairs, config.fftSize * 2); // 2x size for proper overlap-add
+
+    pairs.resize(static_cast<size_t>(numPairs));
+    for (auto& pair : pairs)
+        pair.allocate(config.fftSize);
+    DEBUG_LOG("FFT backends: ", pairs[0].fft.getBackendName(true), " packed, ", pairs[0].fft.getBackendName(false), " unpacked");
+    for (int k = 0; k < numPairs; ++k)
+        hasMidPairs = hasMidPairs || config.pairs[static_cast<size_t>(k)].mid;
+
+    // Start writing ahead of reading by one FFT size
+    outputBufferWritePos = config.fftSize;
+    // First frame fires once a full FFT window has been collected, then every hop
+    samplesUntilNextFrame = config.fftSize;
+
+    int numBins = getNumBins();
+    binParams.resize(numBins);
+
+    for (auto& shiftMap : shiftMaps)
+        shiftMap.allocate(numBins);
+
+    // Curve tables and delay lines (filled and sized by prepareBanks before the engine goes live)
+    builtCurveTables.allocate(getCurveTableLayout(config));
+    DelayReach noReach;
+    for (auto& sideReach : noReach)
+        sideReach.assign(static_cast<size_t>(numBins), 0.0f);
+    delayLines = allocateDelayLines(config, noReach);
+}
+
+void SpectralEngine::ChannelPair::allocate(int fftSize)
+{
+    const size_t numBins = static_cast<size_t>(fftSize / 2);
+    fft.prepare(fftSize);
+    leftFFTData.assign(2 * static_cast<size_t>(fftSize), 0.0f);
+    rightFFTData.assign(2 * static_cast<size_t>(fftSize), 0.0f);
+    for (auto* v : { &feedbackLeftReal, &feedbackLeftImag, &feedbackRightReal, &feedbackRightImag,
+                     &tempLeftReal, &tempLeftImag, &tempRightReal, &tempRightImag,
+                     &shiftedLeftReal, &shiftedLeftImag, &shiftedRightReal, &shiftedRightImag })
+        v->assign(numBins, 0.0f);
+}
+
+int SpectralEngine::DelayLines::getLongestDelayFrames() const
+{
+    int longest = 0;
+    for (auto& line : channels)
+        longest = std::max(longest, line.getLongestDelayFrames());
+    return longest;
+}
+
+void SpectralEngine::pairChannels(Config& config, const juce::AudioChannelSet& layout)
+{
+    using ChannelSet = juce::AudioChannelSet;
+
+    // Each left channel type, then its right partner
+    static constexpr std::pair<ChannelSet::ChannelType, ChannelSet::ChannelType> partners[] = {
+        { ChannelSet::left, ChannelSet::right },
+        { ChannelSet::leftCentre, ChannelSet::rightCentre },
+        { ChannelSet::leftSurround, ChannelSet::rightSurround },
+        { ChannelSet::leftSurroundSide, ChannelSet::rightSurroundSide },
+        { ChannelSet::leftSurroundRear, ChannelSet::rightSurroundRear },
+        { ChannelSet::wideLeft, ChannelSet::wideRight },
+        { ChannelSet::topFrontLeft, ChannelSet::topFrontRight },
+        { ChannelSet::topSideLeft, ChannelSet::topSideRight },
+        { ChannelSet::topRearLeft, ChannelSet::topRearRight },
+    };
+
+    config.numChannels = juce::jlimit(1, kMaxChannels, layout.size());
+    config.numPairs = 0;
+
+    std::array<bool, kMaxChannels> paired {};
+    std::vector<int> lone;
+    for (int channel = 0; channel < config.numChannels; ++channel)
+    {
+        if (paired[static_cast<size_t>(channel)])
+            continue;
+
+        const auto type = layout.getTypeOfChannel(channel);
+        int partner = -1;
+        bool isLeft = true;
+        for (const auto& [leftType, rightType] : partners)
+        {
+            if (type != leftType && type != rightType)
+                continue;
+            isLeft = type == leftType;
+            partner = layout.getChannelIndexForType(isLeft ? rightType : leftType);
+            break;
+        }
+
+        if (partner > channel && partner < config.numChannels)
+        {
+            paired[static_cast<size_t>(partner)] = true;
+            config.pairs[static_cast<size_t>(config.numPairs++)] = isLeft ? ChannelPairing { channel, partner }
+                                                                          : ChannelPairing { partner, channel };
+        }
+        else
+        {
+            lone.push_back(channel);
+        }
+    }
+
+    // Lone channels two to a pair, after the left/right pairs
+    for (size_t i = 0; i < lone.size(); i += 2)
+        config.pairs[static_cast<size_t>(config.numPairs++)] = { lone[i], i + 1 < lone.size() ? lone[i + 1] : -1, true };
+}
+
+std::unique_ptr<SpectralEngine::DelayLines> SpectralEngine::allocateDelayLines(const Config& config, const DelayReach& reach)
+{
+    const int numPairs = juce::jlimit(1, kMaxChannels, config.numPairs);
+    auto lines = std::make_unique<DelayLines>(2 * numPairs);
+    lines->maxDelaySamples = config.maxDelaySamples;
+
+    // Size each bin's line (in frames) for its reach, with a little headroom for
+    // the rounding of the morph, within the overall capacity. Every pair's lines
+    // come out the same, so they're worked out once per side.
+    const int hopSize = config.fftSize / config.overlapFactor;
+    const int maxDelayFrames = config.maxDelaySamples / hopSize;
+    std::array<std::vector<int>, kNumSides> framesPerBin;
+    for (size_t side = 0; side < kNumSides; ++side)
+    {
+        framesPerBin[side].resize(reach[side].size());
+        for (size_t bin = 0; bin < framesPerBin[side].size(); ++bin)
+        {
+            int frames = static_cast<int>(reach[side][bin] * 1.0001f + 1.0f) / hopSize;
+            framesPerBin[side][bin] = std::clamp(frames, 0, maxDelayFrames - 1);
+        }
+    }
+
+    size_t numBytes = 0;
+    for (size_t channel = 0; channel < lines->channels.size(); ++channel)
+    {
+        const auto side = static_cast<size_t>(sideOf(config.pairs[channel / 2], static_cast<int>(channel)));
+        if (lines->firstOfSide[side] < 0)
+            lines->firstOfSide[side] = static_cast<int>(channel);
+        lines->channels[channel].allocate(framesPerBin[side], config.halfPrecisionDelays, config.fftSize / 2.0f);
+        numBytes += lines->channels[channel].getNumBytes();
+    }
+
+    DEBUG_LOG("Allocated delay lines: ", numBytes / 1024, " KB for up to ", maxDelayFrames, " frames");
+    return lines;
+}
+
+std::unique_ptr<SpectralEngine::DelayLines> SpectralEngine::createDelayLines(const Config& config,
+                                                                             const std::array<Bank, 4>& banks)
+{
+    CurveTables tables;
+    tables.allocate(getCurveTableLayout(config));
+    tables.compile(banks);
+    return allocateDelayLines(config, computeDelayReach(config, banks, tables));
+}
+
+void SpectralEngine::takeOverDelayLines(std::unique_ptr<DelayLines>& lines)
+{
+    for (size_t channel = 0; channel < lines->channels.size(); ++channel)
+        lines->channels[channel].continueFrom(delayLines->channels[channel]);
+    std::swap(delayLines, lines);
+
+    config.maxDelaySamples = delayLines->maxDelaySamples;
+    longestDelayFrames = delayLines->getLongestDelayFrames();
+    previousDelayLinesFrames = longestDelayFrames + 1;
+
+    // Delays were held to the old lines' capacity
+    stageValid[DelayStage] = false;
+}
+
+CurveTableLayout SpectralEngine::getCurveTableLayout(const Config& config)
+{
+    CurveTableLayout layout;
+    layout.sampleRate = config.sampleRate;
+    layout.curveSampleRate = config.curveSampleRate > 0.0 ? config.curveSampleRate : config.sampleRate;
+    layout.fftSize = config.fftSize;
+    return layout;
+}
+
+void SpectralEngine::prepareBanks(const std::array<Bank, 4>& banks)
+{
+    builtCurveTables.compile(banks);
+    delayLines = allocateDelayLines(config, computeDelayReach(config, banks, builtCurveTables));
+    longestDelayFrames = delayLines->getLongestDelayFrames();
+    stageValid[DelayStage] = false;
+}
+
+double SpectralEngine::getEchoTailSeconds(const Config& config, const std::array<Bank, 4>& banks)
+{
+    // The morph only blends the banks, so no bin is delayed longer, or fed back
+    // louder, than the highest point of any bank's curve gives
+    auto highestPoint = [](const PiecewiseFunction& curve)
+    {
+        float highest = 0.0f;
+        for (const auto& point : curve.getPoints())
+            highest = std::max(highest, point.y);
+        return highest;
+    };
+
+    double longestMs = 0.0;
+    double loudestFeedback = 0.0;
+    for (const auto& bank : banks)
+    {
+        auto delayMs = [&](CurveType curve, float maxMs, bool useLogScale)
+        {
+            const float value = highestPoint(bank.getCurve(curve));
+            return useLogScale ? std::pow(std::max(maxMs, 1.0f), value) : value * maxMs;
+        };
+        longestMs = std::max({ longestMs, static_cast<double>(delayMs(CurveType::DelayL, bank.delayMaxTimeMsL, bank.delayLogScaleL)),
+                               static_cast<double>(delayMs(CurveType::DelayR, bank.delayMaxTimeMsR, bank.delayLogScaleR)) });
+
+        // Same mapping as evaluateBinParameters
+        for (auto curve : { CurveType::FeedbackL, CurveType::FeedbackR })
+        {
+            const float value = highestPoint(bank.getCurve(curve));
+            if (value > 0.0f)
+                loudestFeedback = std::max(loudestFeedback, std::pow(10.0, (value * 66.0 - 60.0) / 20.0));
+        }
+    }
+
+    // Delays shorter than a hop don't delay (or feed back) at all
+    const double delaySeconds = longestMs / 1000.0;
+    const double hopSeconds = (config.fftSize / config.overlapFactor) / config.sampleRate;
+    if (delaySeconds < hopSeconds)
+        return 0.0;
+    if (loudestFeedback >= 1.0)
+        return std::numeric_limits<double>::infinity();
+
+    // Fed back echoes come round again a frame after they leave the delay line
+    double tailSeconds = delaySeconds;
+    if (loudestFeedback > 0.0)
+    {
+        const double roundTrips = std::ceil(std::log(static_cast<double>(kSilenceThreshold)) / std::log(loudestFeedback));
+        tailSeconds += roundTrips * (delaySeconds + hopSeconds);
+    }
+    return tailSeconds <= kMaxEchoTailSeconds ? tailSeconds : std::numeric_limits<double>::infinity();
+}
+
+SpectralEngine::DelayReach SpectralEngine::computeDelayReach(const Config& config, const std::array<Bank, 4>& banks,
+                                                             const CurveTables& tables)
+{
+    DelayReach reach;
+
+    // The morph only blends the banks, so a bin's delay is at most what the
+    // largest curve value and max time give (log scale: max time ^ value ms)
+    auto computeReach = [&](CurveType curve, float Bank::* maxTimeMs, bool Bank::* logScale,
+                            std::vector<float>& channelReach)
+    {
+        float longestMs = 0.0f;
+        bool anyLogScale = false;
+        for (auto& bank : banks)
+        {
+            longestMs = std::max(longestMs, bank.*maxTimeMs);
+            anyLogScale = anyLogScale || bank.*logScale;
+        }
+
+        const auto& curves = tables.curves;
+        const size_t c = static_cast<size_t>(curve);
+        channelReach.resize(static_cast<size_t>(tables.layout.getNumBins()));
+        for (size_t bin = 0; bin < channelReach.size(); ++bin)
+        {
+            float value = std::max({ curves[0][c][bin], curves[1][c][bin], curves[2][c][bin], curves[3][c][bin] });
+            float ms = value * longestMs;
+            if (anyLogScale)
+                ms = std::max(ms, std::pow(std::max(longestMs, 1.0f), value));
+            channelReach[bin] = ms / 1000.0f * static_cast<float>(config.sampleRate);
+        }
+    };
+    computeReach(CurveType::DelayL, &Bank::delayMaxTimeMsL, &Bank::delayLogScaleL, reach[Left]);
+    computeReach(CurveType::DelayR, &Bank::delayMaxTimeMsR, &Bank::delayLogScaleR, reach[Right]);
+
+    // A mid delay is the mean of the two, so it reaches no further than either
+    reach[Mid].resize(reach[Left].size());
+    for (size_t bin = 0; bin < reach[Mid].size(); ++bin)
+        reach[Mid][bin] = std::max(reach[Left][bin], reach[Right][bin]);
+    return reach;
+}
+
+void SpectralEngine::process(const float* const* input, float* const* wet, int numSamples, bool isPrimary)
+{
+    // Each side of pair k has ring channel 2k + side
+    const int numRingChannels = inputBuffer.getNumChannels();
+    auto channelOf = [this](int ringChannel)
+    {
+        const auto& pairing = config.pairs[static_cast<size_t>(ringChannel / 2)];
+        const int channel = (ringChannel % 2 == 0) ? pairing.left : pairing.right;
+        return channel < config.numChannels ? channel : -1; // -1 also for a lone channel's unused side
+    };
+
+    // Walk the block in chunks that end exactly on hop boundaries: each chunk is
+    // copied into the input ring as a span, its output is copied straight out of
+    // the output ring, and a frame is processed whenever a hop's worth of input is in.
+    int chunkStart = 0;
+    while (chunkStart < numSamples)
+    {
+        int chunkLength = std::min(numSamples - chunkStart, samplesUntilNextFrame);
+
+        // Write input samples to ring (silence on the unused side of a lone channel's pair)
+        for (int ringChannel = 0; ringChannel < numRingChannels; ++ringChannel)
+        {
+            const int channel = channelOf(ringChannel);
+            if (channel >= 0)
+                inputBuffer.write(ringChannel, inputBufferWritePos, input[channel] + chunkStart, chunkLength);
+            else
+                inputBuffer.clear(ringChannel, inputBufferWritePos, chunkLength);
+        }
+
+        // Read output samples from ring (post overlap-add), then clear the consumed
+        // span so the next overlap-add starts from silence
+        for (int ringChannel = 0; ringChannel < numRingChannels; ++ringChannel)
+        {
+            const int channel = channelOf(ringChannel);
+            if (channel >= 0)
+                outputBuffer.read(ringChannel, outputBufferReadPos, wet[channel] + chunkStart, chunkLength);
+            outputBuffer.clear(ringChannel, outputBufferReadPos, chunkLength);
+        }
+
+        inputBufferWritePos = inputBuffer.wrap(inputBufferWritePos + chunkLength);
+        outputBufferReadPos = outputBuffer.wrap(outputBufferReadPos + chunkLength);
+        samplesUntilNextFrame -= chunkLength;
+        chunkStart += chunkLength;
+
+        // Process when a full hop of new input has arrived
+        if (samplesUntilNextFrame == 0)
+        {
+            processFFTFrame(isPrimary);
+            samplesUntilNextFrame = getHopSize();
+        }
+    }
+}
+
+void SpectralEngine::BinParameterArrays::resize(int numBins)
+{
+    for (auto* v : { &delayL, &delayR, &leftToLeft, &leftToRight, &rightToRight, &rightToLeft,
+                     &feedbackL, &feedbackR, &preGainL, &preGainR, &minGateL, &minGateR,
+                     &maxClipL, &maxClipR, &shiftL, &shiftR, &multiplyL, &multiplyR,
+                     &shiftTargetL, &shiftTargetR, &feedbackGainL, &feedbackGainR,
+                     &delayMid, &feedbackMid, &preGainMid, &minGateMid, &maxClipMid, &shiftTargetMid, &feedbackGainMid })
+        v->assign(static_cast<size_t>(numBins), 0.0f);
+    for (auto* v : { &delayFramesL, &delayFramesR, &delayFramesMid })
+        v->assign(static_cast<size_t>(numBins), 0);
+}
+
+SpectralEngine::BinParameterArrays::SideView SpectralEngine::BinParameterArrays::getSide(Side side) const
+{
+    if (side == Left)
+        return { delayFramesL, feedbackGainL, preGainL, minGateL, maxClipL };
+    if (side == Right)
+        return { delayFramesR, feedbackGainR, preGainR, minGateR, maxClipR };
+    return { delayFramesMid, feedbackGainMid, preGainMid, minGateMid, maxClipMid };
+}
+
+int SpectralEngine::updateStageSources(const std::array<Bank, 4>& banks, const SkipFlags& skip,
+                                       const std::array<float, 4>& weights, bool shiftBeforeMult)
+{
+    const auto& ids = frameCurveTables->ids;
+    auto morph = [&](auto member)
+    {
+        return weights[0] * banks[0].*member + weights[1] * banks[1].*member
+             + weights[2] * banks[2].*member + weights[3] * banks[3].*member;
+    };
+
+    auto update = [&](Stage stage, bool skipped, std::initializer_list<CurveType> curves,
+                      std::array<float, 4> settings)
+    {
+        if (skipped)
+        {
+            stageValid[stage] = false; // its arrays go stale while it isn't evaluated
+            return 0;
+        }
+
+        StageSource source;
+        source.weights = weights;
+        source.settings = settings;
+        size_t i = 0;
+        for (auto ct : curves)
+            for (size_t b = 0; b < banks.size(); ++b)
+                source.curveIds[i++] = ids[b][static_cast<size_t>(ct)];
+
+        if (stageValid[stage] && source == stageSources[stage])
+            return 0;
+
+        stageSources[stage] = source;
+        stageValid[stage] = true;
+        return 1 << stage;
+    };
+
+    // Delay settings: morphed max time, and log scale where most of the weight has it
+    float logScaleWeightL = weights[0] * (banks[0].delayLogScaleL ? 1.0f : 0.0f) +
+                            weights[1] * (banks[1].delayLogScaleL ? 1.0f : 0.0f) +
+                            weights[2] * (banks[2].delayLogScaleL ? 1.0f : 0.0f) +
+                            weights[3] * (banks[3].delayLogScaleL ? 1.0f : 0.0f);
+    float logScaleWeightR = weights[0] * (banks[0].delayLogScaleR ? 1.0f : 0.0f) +
+                            weights[1] * (banks[1].delayLogScaleR ? 1.0f : 0.0f) +
+                            weights[2] * (banks[2].delayLogScaleR ? 1.0f : 0.0f) +
+                            weights[3] * (banks[3].delayLogScaleR ? 1.0f : 0.0f);
+
+    int stale = 0;
+    stale |= update(DelayStage, skip.delay, { CurveType::DelayL, CurveType::DelayR },
+                    { morph(&Bank::delayMaxTimeMsL), morph(&Bank::delayMaxTimeMsR),
+                      logScaleWeightL > 0.5f ? 1.0f : 0.0f, logScaleWeightR > 0.5f ? 1.0f : 0.0f });
+    stale |= update(PanStage, skip.pan, { CurveType::PanL, CurveType::PanR }, {});
+    stale |= update(FeedbackStage, skip.feedback, { CurveType::FeedbackL, CurveType::FeedbackR }, {});
+    stale |= update(DynamicsStage, skip.dynamics,
+                    { CurveType::PreGainL, CurveType::PreGainR, CurveType::MinGateL,
+                      CurveType::MinGateR, CurveType::MaxClipL, CurveType::MaxClipR }, {});
+    stale |= update(ShiftStage, skip.shift,
+                    { CurveType::ShiftL, CurveType::ShiftR, CurveType::MultiplyL, CurveType::MultiplyR },
+                    { shiftBeforeMult ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f });
+    return stale;
+}
+
+void SpectralEngine::evaluateBinParameters(int stages, const std::array<float, 4>& w, int begin, int end)
+{
+    const int rangeLength = end - begin;
+    auto& p = binParams;
+
+    // Helper: morph-interpolate the compiled tables of all 4 banks into dest
+    const auto& tables = frameCurveTables->curves;
+    auto evalCurve4 = [&](CurveType ct, std::vector<float>& dest)
+    {
+        size_t ci = static_cast<size_t>(ct);
+        float* d = dest.data() + begin;
+        juce::FloatVectorOperations::copyWithMultiply(d, tables[0][ci].data() + begin, w[0], rangeLength);
+        juce::FloatVectorOperations::addWithMultiply(d, tables[1][ci].data() + begin, w[1], rangeLength);
+        juce::FloatVectorOperations::addWithMultiply(d, tables[2][ci].data() + begin, w[2], rangeLength);
+        juce::FloatVectorOperations::addWithMultiply(d, tables[3][ci].data() + begin, w[3], rangeLength);
+    };
+
+    // Mid settings: the mean of the L and R ones, once they're linear values
+    auto evalMid = [&](const std::vector<float>& l, const std::vector<float>& r, std::vector<float>& mid)
+    {
+        if (!hasMidPairs)
+            return;
+        juce::FloatVectorOperations::add(mid.data() + begin, l.data() + begin, r.data() + begin, rangeLength);
+        juce::FloatVectorOperations::multiply(mid.data() + begin, 0.5f, rangeLength);
+    };
+
+    // Delay curves
+    if (stages & (1 << DelayStage))
+    {
+        evalCurve4(CurveType::DelayL, p.delayL);
+        evalCurve4(CurveType::DelayR, p.delayR);
+
+        const auto& settings = stageSources[DelayStage].settings;
+
+        // Normalized curve value -> delay in samples
+        auto toSamples = [this, begin, end](std::vector<float>& delay, float maxMs, bool useLogScale)
+        {
+            if (useLogScale)
+            {
+                // maxMs^value
+                const float log2MaxMs = std::log2(std::max(maxMs, std::numeric_limits<float>::min()));
+                for (int bin = begin; bin < end; ++bin)
+                    delay[bin] = fastExp2(delay[bin] * log2MaxMs) / 1000.0f * config.sampleRate;
+            }
+            else
+            {
+                for (int bin = begin; bin < end; ++bin)
+                    delay[bin] = (delay[bin] * maxMs) / 1000.0f * config.sampleRate;
+            }
+        };
+        toSamples(p.delayL, settings[0], settings[2] != 0.0f);
+        toSamples(p.delayR, settings[1], settings[3] != 0.0f);
+        evalMid(p.delayL, p.delayR, p.delayMid);
+
+        const int hopSize = getHopSize();
+        const int maxDelayFrames = config.maxDelaySamples / hopSize;
+        bool overCapacity = false;
+        auto toFrames = [&](const std::vector<float>& delay, std::vector<int>& frames, Side side)
+        {
+            // Every line on a side is sized alike, so the first stands for all
+            const int line = delayLines->firstOfSide[static_cast<size_t>(side)];
+            if (line < 0)
+                return; // no pair runs on this side
+            const auto& arena = delayLines->channels[static_cast<size_t>(line)];
+            for (int bin = begin; bin < end; ++bin)
+            {
+                int delayFrames = std::clamp(static_cast<int>(delay[bin]) / hopSize, 0, maxDelayFrames - 1);
+                frames[bin] = std::min(delayFrames, arena.getMaxDelayFrames(bin));
+                overCapacity = overCapacity || frames[bin] != delayFrames;
+            }
+        };
+        toFrames(p.delayL, p.delayFramesL, Left);
+        toFrames(p.delayR, p.delayFramesR, Right);
+        toFrames(p.delayMid, p.delayFramesMid, Mid);
+        if (overCapacity)
+            delayOverCapacity = true;
+    }
+
+    // Pan curves -> crossfeed gains
+    if (stages & (1 << PanStage))
+    {
+        evalCurve4(CurveType::PanL, p.leftToLeft);
+        evalCurve4(CurveType::PanR, p.rightToRight);
+        for (int bin = begin; bin < end; ++bin)
+        {
+            const float halfPi = juce::MathConstants<float>::halfPi;
+            fastSinCos(p.leftToLeft[bin] * halfPi, p.leftToRight[bin], p.leftToLeft[bin]);
+            fastSinCos(p.rightToRight[bin] * halfPi, p.rightToLeft[bin], p.rightToRight[bin]);
+        }
+    }
+
+    // Feedback curves
+    if (stages & (1 << FeedbackStage))
+    {
+        auto toFeedbackGain = [begin, end](std::vector<float>& fb)
+        {
+            for (int bin = begin; bin < end; ++bin)
+                fb[bin] = (fb[bin] <= 0.0f) ? 0.0f : fastDecibelsToGain((fb[bin] * 66.0f) - 60.0f);
+        };
+        evalCurve4(CurveType::FeedbackL, p.feedbackL);
+        evalCurve4(CurveType::FeedbackR, p.feedbackR);
+        toFeedbackGain(p.feedbackL);
+        toFeedbackGain(p.feedbackR);
+        evalMid(p.feedbackL, p.feedbackR, p.feedbackMid);
+    }
+
+    // Dynamics curves
+    if (stages & (1 << DynamicsStage))
+    {
+        auto interpolateDynamicsCurve = [&](CurveType ct, std::vector<float>& dest)
+        {
+            evalCurve4(ct, dest);
+            for (int bin = begin; bin < end; ++bin)
+            {
+                float norm = dest[bin];
+                dest[bin] = (norm <= 0.0f) ? 0.0f : fastDecibelsToGain((norm * 60.0f) - 60.0f);
+            }
+        };
+
+        interpolateDynamicsCurve(CurveType::PreGainL, p.preGainL);
+        interpolateDynamicsCurve(CurveType::PreGainR, p.preGainR);
+        interpolateDynamicsCurve(CurveType::MinGateL, p.minGateL);
+        interpolateDynamicsCurve(CurveType::MinGateR, p.minGateR);
+        interpolateDynamicsCurve(CurveType::MaxClipL, p.maxClipL);
+        interpolateDynamicsCurve(CurveType::MaxClipR, p.maxClipR);
+        evalMid(p.preGainL, p.preGainR, p.preGainMid);
+        evalMid(p.minGateL, p.minGateR, p.minGateMid);
+        evalMid(p.maxClipL, p.maxClipR, p.maxClipMid);
+    }
+
+    // Shift/multiply curves
+    if (stages & (1 << ShiftStage))
+    {
+        evalCurve4(CurveType::ShiftL, p.shiftL);
+        evalCurve4(CurveType::ShiftR, p.shiftR);
+        evalCurve4(CurveType::MultiplyL, p.multiplyL);
+        evalCurve4(CurveType::MultiplyR, p.multiplyR);
+
+        const bool shiftBeforeMult = stageSources[ShiftStage].settings[0] != 0.0f;
+        float binFreqStep = static_cast<float>(config.sampleRate) / static_cast<float>(config.fftSize);
+        for (int bin = begin; bin < end; ++bin)
+        {
+            float binFreq = bin * binFreqStep;
+
+            // Fixed absolute formulas (display ranges are zoom-only, don't affect audio)
+            // Shift: Y=0 → -10000Hz, Y=0.5 → 0Hz, Y=1 → +10000Hz
+            float shiftHzL = (p.shiftL[bin] - 0.5f) * 20000.0f;
+            float shiftHzR = (p.shiftR[bin] - 0.5f) * 20000.0f;
+
+            // Multiply: Y=0 → 0.1x, Y=0.5 → 1.0x, Y=1 → 10.0x (logarithmic)
+            float multFactorL = fastPow10(2.0f * p.multiplyL[bin] - 1.0f);
+            float multFactorR = fastPow10(2.0f * p.multiplyR[bin] - 1.0f);
+
+            // Compute target frequency based on application order
+            float targetFreqL, targetFreqR;
+            if (shiftBeforeMult)
+            {
+                targetFreqL = (binFreq + shiftHzL) * multFactorL;
+                targetFreqR = (binFreq + shiftHzR) * multFactorR;
+            }
+            else
+            {
+                targetFreqL = binFreq * multFactorL + shiftHzL;
+                targetFreqR = binFreq * multFactorR + shiftHzR;
+            }
+
+            // Convert target frequency back to bin index (fractional)
+            p.shiftTargetL[bin] = targetFreqL / binFreqStep;
+            p.shiftTargetR[bin] = targetFreqR / binFreqStep;
+        }
+        evalMid(p.shiftTargetL, p.shiftTargetR, p.shiftTargetMid);
+    }
+
+    // Feedback gain actually applied: none unless the bin is delayed far enough
+    // for feedback to be safe
+    if (stages & ((1 << DelayStage) | (1 << FeedbackStage)))
+    {
+        const int minFeedbackDelayFrames = getMinFeedbackDelayFrames();
+        for (int bin = begin; bin < end; ++bin)
+        {
+            p.feedbackGainL[bin] = (p.delayFramesL[bin] >= minFeedbackDelayFrames) ? p.feedbackL[bin] : 0.0f;
+            p.feedbackGainR[bin] = (p.delayFramesR[bin] >= minFeedbackDelayFrames) ? p.feedbackR[bin] : 0.0f;
+            p.feedbackGainMid[bin] = (p.delayFramesMid[bin] >= minFeedbackDelayFrames) ? p.feedbackMid[bin] : 0.0f;
+        }
+    }
+
+    // Stages not evaluated keep what they held: either still current, or not read this frame
+}
+
+void SpectralEngine::updateActiveBins(int stages)
+{
+    const int numBins = getNumBins();
+    const auto& p = binParams;
+
+    auto findActive = [numBins](auto isActive)
+    {
+        BinRange range { 0, numBins };
+        while (range.begin < range.end && !isActive(range.begin))
+            ++range.begin;
+        while (range.end > range.begin && !isActive(range.end - 1))
+            --range.end;
+        return range;
+    };
+
+    if (stages & (1 << DelayStage))
+    {
+        delayBins[Left] = findActive([&](int bin) { return p.delayFramesL[bin] > 0; });
+        delayBins[Right] = findActive([&](int bin) { return p.delayFramesR[bin] > 0; });
+        delayBins[Mid] = findActive([&](int bin) { return p.delayFramesMid[bin] > 0; });
+    }
+
+    if (stages & (1 << PanStage))
+    {
+        panBins = findActive([&](int bin)
+        {
+            return p.leftToLeft[bin] != 1.0f || p.leftToRight[bin] != 0.0f
+                || p.rightToRight[bin] != 1.0f || p.rightToLeft[bin] != 0.0f;
+        });
+    }
+
+    if (stages & ((1 << DelayStage) | (1 << FeedbackStage)))
+    {
+        feedbackBins[Left] = findActive([&](int bin) { return p.feedbackGainL[bin] != 0.0f; });
+        feedbackBins[Right] = findActive([&](int bin) { return p.feedbackGainR[bin] != 0.0f; });
+        feedbackBins[Mid] = findActive([&](int bin) { return p.feedbackGainMid[bin] != 0.0f; });
+    }
+
+    // Same identity as the skip flags: unity pre-gain, no gate, clip at full scale
+    if (stages & (1 << DynamicsStage))
+    {
+        dynamicsBins[Left] = findActive([&](int bin)
+        {
+            return p.preGainL[bin] != 1.0f || p.minGateL[bin] != 0.0f || p.maxClipL[bin] != 1.0f;
+        });
+        dynamicsBins[Right] = findActive([&](int bin)
+        {
+            return p.preGainR[bin] != 1.0f || p.minGateR[bin] != 0.0f || p.maxClipR[bin] != 1.0f;
+        });
+        dynamicsBins[Mid] = findActive([&](int bin)
+        {
+            return p.preGainMid[bin] != 1.0f || p.minGateMid[bin] != 0.0f || p.maxClipMid[bin] != 1.0f;
+        });
+    }
+}
+
+int SpectralEngine::getMinFeedbackDelayFrames() const
+{
+    // Minimum delay in frames for feedback to be safe (~1ms)
+    return std::max(1, static_cast<int>((config.sampleRate * 0.001f) / getHopSize()));
+}
+
+void SpectralEngine::ShiftMap::allocate(int numBins)
+{
+    rowStart.assign(static_cast<size_t>(numBins) + 1, 0);
+    rowFill.assign(static_cast<size_t>(numBins), 0);
+    sources.assign(2 * static_cast<size_t>(numBins), 0);
+    weights.assign(2 * static_cast<size_t>(numBins), 0.0f);
+}
+
+void SpectralEngine::ShiftMap::build(const float* targets, int numBins)
+{
+    // Each source lands on its fractional target bin split linearly between the
+    // two neighbours, or whole on the last bin; targets outside the spectrum drop
+    auto forEachEntry = [&](auto&& addEntry)
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const float target = targets[bin];
+            if (target >= 0.0f && target < numBins - 1)
+            {
+                const int lo = static_cast<int>(target);
+                const float frac = target - lo;
+                addEntry(lo, bin, 1.0f - frac);
+                addEntry(lo + 1, bin, frac);
+            }
+            else if (target >= 0.0f && target < numBins)
+            {
+                addEntry(static_cast<int>(target), bin, 1.0f);
+            }
+        }
+    };
+
+    // Counting sort by target, keeping sources in ascending order within a row
+    std::fill(rowFill.begin(), rowFill.end(), 0);
+    forEachEntry([&](int target, int, float) { ++rowFill[static_cast<size_t>(target)]; });
+
+    rowStart[0] = 0;
+    for (int t = 0; t < numBins; ++t)
+    {
+        rowStart[static_cast<size_t>(t) + 1] = rowStart[static_cast<size_t>(t)] + rowFill[static_cast<size_t>(t)];
+        rowFill[static_cast<size_t>(t)] = rowStart[static_cast<size_t>(t)];
+    }
+
+    forEachEntry([&](int target, int source, float weight)
+    {
+        const int entry = rowFill[static_cast<size_t>(target)]++;
+        sources[static_cast<size_t>(entry)] = source;
+        weights[static_cast<size_t>(entry)] = weight;
+    });
+
+    // Rows that only pass their own bin through (other sources at weight 0)
+    auto isIdentityRow = [&](int t)
+    {
+        bool passesOwnBin = false;
+        for (int e = rowStart[static_cast<size_t>(t)]; e < rowStart[static_cast<size_t>(t) + 1]; ++e)
+        {
+            const float weight = weights[static_cast<size_t>(e)];
+            if (sources[static_cast<size_t>(e)] == t && weight == 1.0f)
+                passesOwnBin = true;
+            else if (weight != 0.0f)
+                return false;
+        }
+        return passesOwnBin;
+    };
+    activeBegin = 0;
+    activeEnd = numBins;
+    while (activeBegin < activeEnd && isIdentityRow(activeBegin))
+        ++activeBegin;
+    while (activeEnd > activeBegin && isIdentityRow(activeEnd - 1))
+        --activeEnd;
+}
+
+void SpectralEngine::ShiftMap::apply(const float* re, const float* im, float* outRe, float* outIm,
+                                     int begin, int end) const
+{
+    const int gatherBegin = std::clamp(activeBegin, begin, end);
+    const int gatherEnd = std::clamp(activeEnd, gatherBegin, end);
+    for (auto [first, last] : { std::make_pair(begin, gatherBegin), std::make_pair(gatherEnd, end) })
+    {
+        if (first < last)
+        {
+            std::memcpy(outRe + first, re + first, static_cast<size_t>(last - first) * sizeof(float));
+            std::memcpy(outIm + first, im + first, static_cast<size_t>(last - first) * sizeof(float));
+        }
+    }
+
+    const int* src = sources.data();
+    const float* w = weights.data();
+    for (int t = gatherBegin; t < gatherEnd; ++t)
+    {
+        float sumRe = 0.0f, sumIm = 0.0f;
+        for (int e = rowStart[static_cast<size_t>(t)]; e < rowStart[static_cast<size_t>(t) + 1]; ++e)
+        {
+            sumRe += re[src[e]] * w[e];
+            sumIm += im[src[e]] * w[e];
+        }
+        outRe[t] = sumRe;
+        outIm[t] = sumIm;
+    }
+}
+
+void SpectralEngine::processFFTFrame(bool isPrimary)
+{
+    frameCounter++;
+    bool shouldLog = (frameCounter <= 3 || frameCounter % 100 == 0);
+
+    if (shouldLog)
+        DEBUG_LOG("=== Processing FFT Frame #", frameCounter, " ===");
+
+    int hopSize = config.fftSize / config.overlapFactor;
+    const bool packedFFT = owner.packedStereoFFT.load();
+
+    int numBins = config.fftSize / 2;
+
+    // Large frames spread their work over the frame workers: the per-pair transforms
+    // (each pair has its own FFT scratch) and the per-bin passes, split into ranges.
+    // Each task only writes its own pair or range.
+    const int numPairBins = numBins * static_cast<int>(pairs.size());
+    FrameWorkerPool* workers = (numPairBins >= kMinParallelBins && owner.frameWorkers->getNumWorkers() > 0
+                                && owner.parallelFrames.load()) ? owner.frameWorkers.get() : nullptr;
+    auto forEachPair = [&](auto&& fn)
+    {
+        if (workers == nullptr || pairs.size() < 2)
+        {
+            for (size_t k = 0; k < pairs.size(); ++k)
+                fn(k);
+            return;
+        }
+        workers->run(static_cast<int>(pairs.size()), [&](int task) { fn(static_cast<size_t>(task)); });
+    };
+    auto forEachBinRange = [&](auto&& fn)
+    {
+        if (workers == nullptr)
+        {
+            fn(0, numBins);
+            return;
+        }
+        const int numTasks = (numBins + kBinsPerTask - 1) / kBinsPerTask;
+        workers->run(numTasks, [&](int task)
+        {
+            const int begin = task * kBinsPerTask;
+            fn(begin, std::min(numBins, begin + kBinsPerTask));
+        });
+    };
+
+    // Copy the most recent FFT window of every pair out of the input ring, window
+    // it and transform it
+    const int frameStart = inputBufferWritePos - config.fftSize;
+    forEachPair([&](size_t k)
+    {
+        auto& pair = pairs[k];
+        inputBuffer.read(static_cast<int>(2 * k), frameStart, pair.leftFFTData.data(), config.fftSize);
+        inputBuffer.read(static_cast<int>(2 * k + 1), frameStart, pair.rightFFTData.data(), config.fftSize);
+
+        if (shouldLog && k == 0)
+        {
+            float inputMagL = 0.0f, inputMagR = 0.0f;
+            for (int i = 0; i < config.fftSize; ++i)
+            {
+                inputMagL = std::max(inputMagL, std::abs(pair.leftFFTData[i]));
+                inputMagR = std::max(inputMagR, std::abs(pair.rightFFTData[i]));
+            }
+            DEBUG_LOG("  Pre-FFT input max - L: ", inputMagL, " R: ", inputMagR);
+        }
+
+        // Analysis window (none for the synthesis-only Hann pair)
+        if (!windows->analysis.empty())
+        {
+            juce::FloatVectorOperations::multiply(pair.leftFFTData.data(), windows->analysis.data(), config.fftSize);
+            juce::FloatVectorOperations::multiply(pair.rightFFTData.data(), windows->analysis.data(), config.fftSize);
+        }
+
+        pair.fft.performRealOnlyForwardTransform(pair.leftFFTData.data(), pair.rightFFTData.data(), packedFFT);
+    });
+
+    if (shouldLog)
+    {
+        const auto& leftFFTData = pairs[0].leftFFTData;
+        DEBUG_LOG("  FFT completed, processing bins...");
+        // Log first few FFT values to understand the format
+        DEBUG_LOG("  Left FFT data[0-10]: ",
+                  leftFFTData[0], " ", leftFFTData[1], " ", leftFFTData[2], " ",
+                  leftFFTData[3], " ", leftFFTData[4], " ", leftFFTData[5]);
+        const int tail = config.fftSize - 8;
+        DEBUG_LOG("  Left FFT data[", tail, "-", tail + 7, "]: ",
+                  leftFFTData[tail], " ", leftFFTData[tail + 1], " ", leftFFTData[tail + 2], " ",
+                  leftFFTData[tail + 3], " ", leftFFTData[tail + 4], " ", leftFFTData[tail + 5], " ",
+                  leftFFTData[tail + 6], " ", leftFFTData[tail + 7]);
+        DEBUG_LOG("  fftSize: ", config.fftSize, " pairs: ", static_cast<int>(pairs.size()));
+    }
+
+    // Process bins: dynamics, delay, feedback, panning
+    float halfN = config.fftSize / 2.0f; // normalization factor for dBFS
+    const float invHalfNSquared = 1.0f / (halfN * halfN);
+
+    // Spectrograph capture buffers
+    bool captureSpectrograph = isPrimary && owner.spectrographEnabled.load();
+    float localSpecL[SpectrasaurusAudioProcessor::kMaxSpectrographBins];
+    float localSpecR[SpectrasaurusAudioProcessor::kMaxSpectrographBins];
+
+    // ===== PHASE 1: Per-bin feedback + dynamics + spectrograph capture =====
+
+    // The active bank snapshot: immutable, and only replaced by this thread between blocks
+    SkipFlags skipFlags;
+    {
+        const auto& snapshot = owner.getActiveBankSnapshot();
+        const auto& banks = snapshot.banks;
+
+        // Curves are only ever evaluated off the audio thread: use the snapshot's
+        // tables, or ours until a snapshot compiled for this layout goes live
+        frameCurveTables = snapshot.findCurveTables(builtCurveTables.layout);
+        if (frameCurveTables == nullptr)
+            frameCurveTables = &builtCurveTables;
+
+        // Morph weights for per-bin interpolation
+        float mx = owner.getMorphX();
+        float my = owner.getMorphY();
+        float wA = (1.0f - mx) * (1.0f - my);
+        float wB = mx * (1.0f - my);
+        float wC = (1.0f - mx) * my;
+        float wD = mx * my;
+
+        // Shift order: use bank with highest weight
+        float maxW = std::max({wA, wB, wC, wD});
+        bool shiftBeforeMult = (maxW == wA) ? banks[0].shiftBeforeMultiply :
+                          (maxW == wB) ? banks[1].shiftBeforeMultiply :
+                          (maxW == wC) ? banks[2].shiftBeforeMultiply :
+                                         banks[3].shiftBeforeMultiply;
+
+        // Identity-skip flags: skip entire processing phases when all banks are at
+        // defaults (worked out when the snapshot was compiled)
+        const auto& activeStages = snapshot.activeStages;
+        skipFlags.delay    = !activeStages.delay;
+        skipFlags.pan      = !activeStages.pan;
+        skipFlags.feedback = !activeStages.feedback;
+        skipFlags.dynamics = !activeStages.dynamics;
+        skipFlags.shift    = !activeStages.shift;
+
+        // Clear feedback buffers when feedback is at identity (ensures clean state on
+        // re-enable); only the bins last stored can be nonzero
+        if (skipFlags.feedback)
+        {
+            auto clearStored = [](float* re, float* im, BinRange stored)
+            {
+                if (stored.isEmpty())
+                    return;
+                std::memset(re + stored.begin, 0, static_cast<size_t>(stored.end - stored.begin) * sizeof(float));
+                std::memset(im + stored.begin, 0, static_cast<size_t>(stored.end - stored.begin) * sizeof(float));
+            };
+            for (size_t k = 0; k < pairs.size(); ++k)
+            {
+                auto& pair = pairs[k];
+                clearStored(pair.feedbackLeftReal.data(), pair.feedbackLeftImag.data(), storedFeedbackBins[sideOf(config.pairs[k], 0)]);
+                clearStored(pair.feedbackRightReal.data(), pair.feedbackRightImag.data(), storedFeedbackBins[sideOf(config.pairs[k], 1)]);
+            }
+            storedFeedbackBins = {};
+        }
+
+        // Only stages whose morph position, curves or settings moved are derived again
+        const std::array<float, 4> weights { wA, wB, wC, wD };
+        if (int staleStages = updateStageSources(banks, skipFlags, weights, shiftBeforeMult))
+        {
+            forEachBinRange([&](int begin, int end)
+            {
+                evaluateBinParameters(staleStages, weights, begin, end);
+            });
+            updateActiveBins(staleStages);
+
+            if (staleStages & (1 << ShiftStage))
+            {
+                shiftMaps[Left].build(binParams.shiftTargetL.data(), numBins);
+                shiftMaps[Right].build(binParams.shiftTargetR.data(), numBins);
+                if (hasMidPairs)
+                    shiftMaps[Mid].build(binParams.shiftTargetMid.data(), numBins);
+            }
+
+            // Delays beyond what the lines were sized for are held back until the
+            // owner has built larger ones for these curves
+            if (delayOverCapacity.exchange(false))
+                owner.requestDelayResize();
+        }
+    } // all bank curve data is now in binParams
+
+    const auto& kernels = SpectralKernels::get(owner.forcedKernelIsa.load());
+
+    // Unpack bins into real/imag arrays (bin 0 has no imaginary part), then feedback,
+    // dynamics and spectrograph capture. Each range runs every pair in turn, so the
+    // range's binParams are read from cache after the first.
+    forEachBinRange([&](int begin, int end)
+    {
+        const int rangeLength = end - begin;
+        const size_t rangeBytes = static_cast<size_t>(rangeLength) * sizeof(float);
+
+        // Each stage below only runs on the bins it changes (see BinRange)
+        auto addFeedback = [&](float* re, float* im, const float* fbRe, const float* fbIm, BinRange bins)
+        {
+            bins = bins.within(begin, end);
+            if (bins.isEmpty())
+                return;
+            juce::FloatVectorOperations::add(re + bins.begin, fbRe + bins.begin, bins.end - bins.begin);
+            juce::FloatVectorOperations::add(im + bins.begin, fbIm + bins.begin, bins.end - bins.begin);
+        };
+        auto applyDynamics = [&](float* re, float* im, const std::vector<float>& preGain, const std::vector<float>& minGate,
+                                 const std::vector<float>& maxClip, BinRange bins)
+        {
+            bins = bins.within(begin, end);
+            if (bins.isEmpty())
+                return;
+            kernels.dynamics(re + bins.begin, im + bins.begin, preGain.data() + bins.begin, minGate.data() + bins.begin,
+                             maxClip.data() + bins.begin, halfN, bins.end - bins.begin);
+        };
+
+        for (size_t k = 0; k < pairs.size(); ++k)
+        {
+            auto& pair = pairs[k];
+            const Side leftSide = sideOf(config.pairs[k], 0);
+            const Side rightSide = sideOf(config.pairs[k], 1);
+
+            std::memcpy(pair.tempLeftReal.data() + begin, pair.leftFFTData.data() + begin, rangeBytes);
+            std::memcpy(pair.tempLeftImag.data() + begin, pair.leftFFTData.data() + numBins + begin, rangeBytes);
+            std::memcpy(pair.tempRightReal.data() + begin, pair.rightFFTData.data() + begin, rangeBytes);
+            std::memcpy(pair.tempRightImag.data() + begin, pair.rightFFTData.data() + numBins + begin, rangeBytes);
+            if (begin == 0)
+            {
+                pair.tempLeftImag[0] = 0.0f;
+                pair.tempRightImag[0] = 0.0f;
+            }
+
+            // Add feedback (skip when all banks have feedback at identity)
+            if (!skipFlags.feedback)
+            {
+                addFeedback(pair.tempLeftReal.data(), pair.tempLeftImag.data(),
+                            pair.feedbackLeftReal.data(), pair.feedbackLeftImag.data(), storedFeedbackBins[leftSide]);
+                addFeedback(pair.tempRightReal.data(), pair.tempRightImag.data(),
+                            pair.feedbackRightReal.data(), pair.feedbackRightImag.data(), storedFeedbackBins[rightSide]);
+            }
+
+            // PreGain + gate/clip (skip when dynamics at identity)
+            if (!skipFlags.dynamics)
+            {
+                const auto left = binParams.getSide(leftSide);
+                const auto right = binParams.getSide(rightSide);
+                applyDynamics(pair.tempLeftReal.data(), pair.tempLeftImag.data(), left.preGain, left.minGate,
+                              left.maxClip, dynamicsBins[leftSide]);
+                applyDynamics(pair.tempRightReal.data(), pair.tempRightImag.data(), right.preGain, right.minGate,
+                              right.maxClip, dynamicsBins[rightSide]);
+            }
+
+            // Identity shift/multiply: direct copy
+            if (skipFlags.shift)
+            {
+                std::memcpy(pair.shiftedLeftReal.data() + begin, pair.tempLeftReal.data() + begin, rangeBytes);
+                std::memcpy(pair.shiftedLeftImag.data() + begin, pair.tempLeftImag.data() + begin, rangeBytes);
+                std::memcpy(pair.shiftedRightReal.data() + begin, pair.tempRightReal.data() + begin, rangeBytes);
+                std::memcpy(pair.shiftedRightImag.data() + begin, pair.tempRightImag.data() + begin, rangeBytes);
+            }
+        }
+
+        // Spectrograph capture, from the first pair
+        if (captureSpectrograph)
+        {
+            const auto& first = pairs[0];
+            int specEnd = std::min(end, SpectrasaurusAudioProcessor::kMaxSpectrographBins);
+            for (int bin = begin; bin < specEnd; ++bin)
+            {
+                // 20 log10(|X| / halfN), from the power so there's no square root
+                float powerL = (first.tempLeftReal[bin] * first.tempLeftReal[bin]
+                                + first.tempLeftImag[bin] * first.tempLeftImag[bin]) * invHalfNSquared;
+                float powerR = (first.tempRightReal[bin] * first.tempRightReal[bin]
+                                + first.tempRightImag[bin] * first.tempRightImag[bin]) * invHalfNSquared;
+                localSpecL[bin] = std::max(-60.0f, 0.5f * fastGainToDecibels(std::max(powerL, 1.0e-12f)));
+                localSpecR[bin] = std::max(-60.0f, 0.5f * fastGainToDecibels(std::max(powerR, 1.0e-12f)));
+            }
+        }
+    });
+
+    // What goes into the delay lines this frame: input plus feedback
+    const float quietLevel = kSilenceThreshold * halfN;
+    bool frameIsQuiet = true;
+    for (const auto& pair : pairs)
+    {
+        for (const auto* bins : { &pair.tempLeftReal, &pair.tempLeftImag, &pair.tempRightReal, &pair.tempRightImag })
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(bins->data(), numBins);
+            frameIsQuiet = frameIsQuiet && range.getStart() > -quietLevel && range.getEnd() < quietLevel;
+        }
+    }
+    if (!frameIsQuiet)
+        quietFrames = 0;
+    else if (!hasDecayed())
+        ++quietFrames;
+
+    // ===== PHASE 2: Per-bin shift/multiply gather + delay + pan + feedback store =====
+    // Shifted bins come from anywhere in the spectrum, so this pass starts after
+    // every range of phase 1 has finished
+    forEachBinRange([&](int begin, int end)
+    {
+        const int rangeLength = end - begin;
+        const size_t rangeBytes = static_cast<size_t>(rangeLength) * sizeof(float);
+        const int imagBegin = std::max(begin, 1);
+
+        const auto pan = panBins.within(begin, end);
+
+        // Feedback store, on the bins with feedback gain. Without delay no bin is
+        // delayed far enough, so feedback is silenced. Bins stored last frame but
+        // not this one go back to zero.
+        auto storeFeedback = [&](float* fbRe, float* fbIm, const float* re, const float* im,
+                                 const std::vector<float>& gain, BinRange bins, BinRange storedBins)
+        {
+            const auto store = skipFlags.delay ? BinRange {} : bins.within(begin, end);
+            const auto stored = storedBins.within(begin, end);
+            auto clear = [&](int first, int last)
+            {
+                if (first >= last)
+                    return;
+                std::memset(fbRe + first, 0, static_cast<size_t>(last - first) * sizeof(float));
+                std::memset(fbIm + first, 0, static_cast<size_t>(last - first) * sizeof(float));
+            };
+
+            if (store.isEmpty())
+            {
+                clear(stored.begin, stored.end);
+                return;
+            }
+            clear(stored.begin, std::min(stored.end, store.begin));
+            clear(std::max(stored.begin, store.end), stored.end);
+            kernels.feedbackStore(fbRe + store.begin, fbIm + store.begin, re + store.begin, im + store.begin,
+                                  gain.data() + store.begin, store.end - store.begin);
+        };
+
+        for (size_t k = 0; k < pairs.size(); ++k)
+        {
+            auto& pair = pairs[k];
+            const Side leftSide = sideOf(config.pairs[k], 0);
+            const Side rightSide = sideOf(config.pairs[k], 1);
+            const auto leftParams = binParams.getSide(leftSide);
+            const auto rightParams = binParams.getSide(rightSide);
+
+            if (!skipFlags.shift)
+            {
+                shiftMaps[leftSide].apply(pair.tempLeftReal.data(), pair.tempLeftImag.data(),
+                                          pair.shiftedLeftReal.data(), pair.shiftedLeftImag.data(), begin, end);
+                shiftMaps[rightSide].apply(pair.tempRightReal.data(), pair.tempRightImag.data(),
+                                           pair.shiftedRightReal.data(), pair.shiftedRightImag.data(), begin, end);
+            }
+
+            // Delay, in place on the shifted arrays (skip entirely when all delay curves are at identity)
+            if (!skipFlags.delay)
+            {
+                const auto left = delayBins[leftSide].within(begin, end);
+                const auto right = delayBins[rightSide].within(begin, end);
+                if (!left.isEmpty())
+                    delayLines->channels[2 * k].process(pair.shiftedLeftReal.data(), pair.shiftedLeftImag.data(),
+                                                        leftParams.delayFrames.data(), left.begin, left.end);
+                if (!right.isEmpty())
+                    delayLines->channels[2 * k + 1].process(pair.shiftedRightReal.data(), pair.shiftedRightImag.data(),
+                                                            rightParams.delayFrames.data(), right.begin, right.end);
+            }
+
+            // Pan crossfeed (skip when all pan curves are at identity, and for lone
+            // channels: the two sides of a mid pair aren't a left and a right)
+            if (!skipFlags.pan && !pan.isEmpty() && !config.pairs[k].mid)
+            {
+                kernels.pan(pair.shiftedLeftReal.data() + pan.begin, pair.shiftedLeftImag.data() + pan.begin,
+                            pair.shiftedRightReal.data() + pan.begin, pair.shiftedRightImag.data() + pan.begin,
+                            binParams.leftToLeft.data() + pan.begin, binParams.leftToRight.data() + pan.begin,
+                            binParams.rightToRight.data() + pan.begin, binParams.rightToLeft.data() + pan.begin,
+                            pan.end - pan.begin);
+            }
+
+            // Feedback store (skip when all feedback curves are at identity)
+            if (!skipFlags.feedback)
+            {
+                storeFeedback(pair.feedbackLeftReal.data(), pair.feedbackLeftImag.data(),
+                              pair.shiftedLeftReal.data(), pair.shiftedLeftImag.data(),
+                              leftParams.feedbackGain, feedbackBins[leftSide], storedFeedbackBins[leftSide]);
+                storeFeedback(pair.feedbackRightReal.data(), pair.feedbackRightImag.data(),
+                              pair.shiftedRightReal.data(), pair.shiftedRightImag.data(),
+                              rightParams.feedbackGain, feedbackBins[rightSide], storedFeedbackBins[rightSide]);
+            }
+
+            // Write to output FFT buffer (data[numBins] is left untouched, as is bin 0's imaginary slot)
+            const size_t imagBytes = static_cast<size_t>(end - imagBegin) * sizeof(float);
+            std::memcpy(pair.leftFFTData.data() + begin, pair.shiftedLeftReal.data() + begin, rangeBytes);
+            std::memcpy(pair.leftFFTData.data() + numBins + imagBegin, pair.shiftedLeftImag.data() + imagBegin, imagBytes);
+            std::memcpy(pair.rightFFTData.data() + begin, pair.shiftedRightReal.data() + begin, rangeBytes);
+            std::memcpy(pair.rightFFTData.data() + numBins + imagBegin, pair.shiftedRightImag.data() + imagBegin, imagBytes);
+        }
+    });
+
+    if (!skipFlags.feedback)
+        storedFeedbackBins = skipFlags.delay ? std::array<BinRange, kNumSides> {} : feedbackBins;
+
+    // Write spectrograph data under lock
+    if (captureSpectrograph)
+    {
+        if (owner.spectrographLock.tryEnter())
+        {
+            owner.spectrographNumBins = std::min(numBins, SpectrasaurusAudioProcessor::kMaxSpectrographBins);
+            std::memcpy(owner.spectrographDataL, localSpecL, owner.spectrographNumBins * sizeof(float));
+            std::memcpy(owner.spectrographDataR, localSpecR, owner.spectrographNumBins * sizeof(float));
+            owner.spectrographLock.exit();
+        }
+    }
+
+    if (shouldLog)
+        DEBUG_LOG("  Bin processing completed, performing IFFT...");
+
+    // Apply the synthesis window (normalization included) and overlap-add in one pass.
+    // Gain and clip are applied later in processBlock after all overlapping frames
+    // are summed, so they work on the final signal.
+    // Only the non-zero part of the synthesis window is added; its first sample lands
+    // on the next output sample, which is what sets the latency.
+    const int olaStart = windows->synthesisStart;
+    const int olaLength = config.fftSize - olaStart;
+    forEachPair([&](size_t k)
+    {
+        auto& pair = pairs[k];
+        pair.fft.performRealOnlyInverseTransform(pair.leftFFTData.data(), pair.rightFFTData.data(), packedFFT);
+
+        if (shouldLog && k == 0)
+        {
+            float outputMagL = 0.0f, outputMagR = 0.0f;
+            for (int i = 0; i < config.fftSize; ++i)
+            {
+                outputMagL = std::max(outputMagL, std::abs(pair.leftFFTData[i] * windows->synthesis[i]));
+                outputMagR = std::max(outputMagR, std::abs(pair.rightFFTData[i] * windows->synthesis[i]));
+            }
+            DEBUG_LOG("  Post-IFFT output max - L: ", outputMagL, " R: ", outputMagR);
+        }
+
+        outputBuffer.addWithMultiply(static_cast<int>(2 * k), outputBufferWritePos, pair.leftFFTData.data() + olaStart,
+                                     windows->synthesis.data() + olaStart, olaLength);
+        outputBuffer.addWithMultiply(static_cast<int>(2 * k + 1), outputBufferWritePos, pair.rightFFTData.data() + olaStart,
+                                     windows->synthesis.data() + olaStart, olaLength);
+    });
+
+    // Advance write position by hop size
+    outputBufferWritePos = outputBuffer.wrap(outputBufferWritePos + hopSize);
+
+    // Once no bin can reach back into replaced delay lines, stop reading them
+    if (previousDelayLinesFrames > 0 && --previousDelayLinesFrames == 0)
+    {
+        for (auto& line : delayLines->channels)
+            line.releasePrevious();
+    }
+
+    if (shouldLog)
+        DEBUG_LOG("=== FFT Frame #", frameCounter, " completed ===");
+}
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "Bank.h"
+#include "BinDelayArena.h"
+#include "CurveTables.h"
+#include "RingBuffer.h"
+#include "SpectralKernels.h"
+#include "STFTWindows.h"
+#include "StereoFFT.h"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+class SpectrasaurusAudioProcessor;
+
+// One complete STFT chain for a fixed configuration (sample rate, FFT size,
+// overlap, window pair, delay capacity, channel count): FFT plan, windows, STFT rings,
+// per-bin delay lines and feedback, curve LUTs and working buffers.
+// Everything is allocated in the constructor, so a new engine can be built off the
+// audio thread and swapped in whole when the FFT size, overlap or window changes.
+//
+// Channels are processed in pairs (see ChannelPairing), and each pair goes through
+// the FFT as one packed stereo frame. All pairs share the FFT plan, the windows and
+// the per-bin parameters, and each per-bin pass runs every pair over a range of
+// bins before moving on.
+class SpectralEngine
+{
+public:
+    static constexpr int kMaxChannels = 16;
+
+    // The channels one pair runs. A left/right pair (L/R, surround, height...) runs
+    // on the banks' L and R curves, with pan crossfeeding between the two. Channels
+    // without a partner (centre, LFE, mono) run two to a pair on the mid settings,
+    // each bin's mean of its L and R settings, without pan; right is -1 when a pair
+    // has only one.
+    struct ChannelPairing
+    {
+        int left = 0;
+        int right = 1;
+        bool mid = false;
+
+        bool operator==(const ChannelPairing& other) const
+        {
+            return left == other.left && right == other.right && mid == other.mid;
+        }
+    };
+
+    // The settings a side of a pair runs on
+    enum Side { Left, Right, Mid, kNumSides };
+
+    struct Config
+    {
+        double sampleRate = 0.0;
+        int fftSize = 2048;
+        int overlapFactor = 4;
+        STFTWindow window = STFTWindow::SynthesisHann;
+        int maxDelaySamples = 48000;
+        int numBands = 1;              // band split, used by MultiResolutionEngine
+        double curveSampleRate = 0.0;  // rate the curves' frequency axis spans (0 = sampleRate)
+        bool halfPrecisionDelays = false; // delay lines store 16-bit floats (see BinDelayArena)
+        int numChannels = 2;              // up to kMaxChannels
+        std::array<ChannelPairing, kMaxChannels> pairs {}; // the first numPairs are used (see pairChannels)
+        int numPairs = 1;
+
+        bool operator==(const Config& other) const
+        {
+            return sampleRate == other.sampleRate && fftSize == other.fftSize
+                && overlapFactor == other.overlapFactor && window == other.window
+                && maxDelaySamples == other.maxDelaySamples && numBands == other.numBands
+                && curveSampleRate == other.curveSampleRate
+                && halfPrecisionDelays == other.halfPrecisionDelays
+                && numChannels == other.numChannels && numPairs == other.numPairs
+                && std::equal(pairs.begin(), pairs.begin() + numPairs, other.pairs.begin());
+        }
+        bool operator!=(const Config& other) const { return !(*this == other); }
+    };
+
+    // Set config's channels and pairs for a bus layout. Channels pair up by type:
+    // left with right, and likewise the left/right centre, surround, side, rear,
+    // wide and height pairs. The rest (centre, LFE, mono, discrete) run on the mid
+    // settings.
+    static void pairChannels(Config& config, const juce::AudioChannelSet& layout);
+
+    // Reads banks, morph, spectrograph and engine options from the owning processor
+    SpectralEngine(SpectrasaurusAudioProcessor& owner, const Config& config);
+
+    const Config& getConfig() const { return config; }
+    int getHopSize() const { return config.fftSize / config.overlapFactor; }
+    int getNumBins() const { return config.fftSize / 2; }
+    int getNumChannels() const { return config.numChannels; }
+
+    // Output lags input by one full FFT window (two hops for the low-latency pair)
+    int getLatencySamples() const { return windows->getLatencySamples(); }
+
+    // First frame after one window, full overlap its latency minus a hop later
+    int getWarmupSamples() const { return config.fftSize + getLatencySamples() - getHopSize(); }
+
+    // Where this engine's bins fall on the curves' frequency axis
+    static CurveTableLayout getCurveTableLayout(const Config& config);
+    const CurveTableLayout& getCurveTableLayout() const { return builtCurveTables.layout; }
+
+    // Evaluate every curve of every bank into the engine's own tables (used until
+    // a bank snapshot brings compiled tables for its layout) and size each bin's
+    // delay lines for the longest delay the banks can give it. Called when building
+    // an engine, off the audio thread.
+    void prepareBanks(const std::array<Bank, 4>& banks);
+
+    // Push numSamples of input (one pointer per channel) through the STFT and write
+    // the overlap-added output (before bank/master gain) to wet. Frames run as hops
+    // complete. Only the primary engine feeds the spectrograph, from the first pair.
+    void process(const float* const* input, float* const* wet, int numSamples, bool isPrimary);
+
+    // Both sides of every pair's per-bin delay lines (including the unused side of
+    // a pair with one channel), replaced together
+    struct DelayLines
+    {
+        explicit DelayLines(int numLines) : channels(static_cast<size_t>(numLines)) {}
+
+        std::vector<BinDelayArena> channels;
+        int maxDelaySamples = 0; // overall capacity they were sized within
+        std::array<int, kNumSides> firstOfSide { -1, -1, -1 }; // lines on a side are sized alike
+
+        int getLongestDelayFrames() const;
+    };
+
+    // Delay lines for an engine with this config, each bin sized for the longest
+    // delay the banks can give it. Not real-time safe; any thread.
+    static std::unique_ptr<DelayLines> createDelayLines(const Config& config, const std::array<Bank, 4>& banks);
+
+    // Audio thread, between frames: continue on `lines` (made by createDelayLines
+    // for this engine's config, whatever its maxDelaySamples), handing the current
+    // lines back through it. Echoes already in the old lines keep coming out of
+    // them, so they must stay alive until isReadingPreviousDelayLines() is false.
+    void takeOverDelayLines(std::unique_ptr<DelayLines>& lines);
+    bool isReadingPreviousDelayLines() const { return previousDelayLinesFrames > 0; }
+
+    // Level (relative to full scale) below which input and spectra count as silence: -120 dB
+    static constexpr float kSilenceThreshold = 1.0e-6f;
+
+    // True once nothing above kSilenceThreshold has gone into the delay lines or the
+    // feedback path for long enough that every echo and the overlap-add have played
+    // out: fed silence from here on, the engine only puts out silence
+    bool hasDecayed() const { return quietFrames > longestDelayFrames + config.overlapFactor; }
+
+    // How long the banks' echoes can go on after the input stops, at any morph
+    // position: the longest delay, then feedback round trips until they fall below
+    // kSilenceThreshold. Infinite when feedback doesn't decay, or when the tail
+    // would be longer than kMaxEchoTailSeconds: hosts turn the tail into a sample
+    // count, and just under 0 dB feedback the decay takes hours, which overflows it.
+    static double getEchoTailSeconds(const Config& config, const std::array<Bank, 4>& banks);
+    static constexpr double kMaxEchoTailSeconds = 600.0; // fits 32-bit sample counts up to 384 kHz
+
+private:
+    SpectrasaurusAudioProcessor& owner;
+    Config config;
+
+    // Analysis window, and synthesis window with the overlap-add normalization
+    // folded in (applied in one pass during OLA). Shared with every other engine
+    // in the process using the same window, size and hop.
+    std::shared_ptr<const STFTWindowPair> windows;
+
+    // STFT input/output rings, two channels per pair (power-of-two, block copies in
+    // and out of process)
+    RingBuffer inputBuffer;
+    RingBuffer outputBuffer;
+
+    int inputBufferWritePos = 0;
+    int outputBufferReadPos = 0;
+    int outputBufferWritePos = 0;
+    int samplesUntilNextFrame = 0; // input samples still needed before the next hop fires
+
+    // Everything a channel pair doesn't share with the others: its FFT (with its own
+    // scratch, so pairs can be transformed in parallel) and frame, feedback and the
+    // per-bin working arrays of processFFTFrame (pre-allocated, so the audio thread
+    // never allocates). "Left" is the pair's first channel.
+    struct ChannelPair
+    {
+        StereoFFT fft;
+        std::vector<float> leftFFTData, rightFFTData;
+
+        // Per-bin feedback buffers (real + imag per bin, per channel)
+        std::vector<float> feedbackLeftReal, feedbackLeftImag;
+        std::vector<float> feedbackRightReal, feedbackRightImag;
+
+        std::vector<float> tempLeftReal, tempLeftImag, tempRightReal, tempRightImag;
+        std::vector<float> shiftedLeftReal, shiftedLeftImag, shiftedRightReal, shiftedRightImag;
+
+        void allocate(int fftSize);
+    };
+    std::vector<ChannelPair> pairs;
+    bool hasMidPairs = false; // the mid settings are only derived for a layout that uses them
+
+    static Side sideOf(const ChannelPairing& pairing, int ringChannel)
+    {
+        return pairing.mid ? Mid : (ringChannel % 2 == 0 ? Left : Right);
+    }
+
+    // Per-bin delay lines, sized for the longest delay any morph position of the
+    // banks they were made for can give each bin. A frame asking for more is held
+    // to what the lines have, and the owner builds larger ones for the new curves.
+    std::unique_ptr<DelayLines> delayLines;
+    int previousDelayLinesFrames = 0; // frames until the replaced lines are out of reach
+    int longestDelayFrames = 0;       // longest delay the lines can give any bin
+    int quietFrames = 0;              // consecutive frames with no bin above kSilenceThreshold
+    std::atomic<bool> delayOverCapacity { false };
+
+    // Longest delay (in samples) the banks can give each bin, per side
+    using DelayReach = std::array<std::vector<float>, kNumSides>;
+    static DelayReach computeDelayReach(const Config& config, const std::array<Bank, 4>& banks, const CurveTables& tables);
+    static std::unique_ptr<DelayLines> allocateDelayLines(const Config& config, const DelayReach& reach);
+
+    // Curve tables built with the engine, and the ones the current frame reads:
+    // the active snapshot's for this layout when it has them, else builtCurveTables
+    CurveTables builtCurveTables;
+    const CurveTables* frameCurveTables = nullptr;
+
+    void processFFTFrame(bool isPrimary);
+
+    // Frames with at least kMinParallelBins bins (counting every pair's) spread their
+    // per-pair transforms and per-bin passes across the owner's frame workers, one
+    // pair or kBinsPerTask bins per task (one task's slice of the per-bin arrays
+    // stays in L2)
+    static constexpr int kMinParallelBins = 2048;
+    static constexpr int kBinsPerTask = 512;
+
+    // Per-engine debug counter
+    int frameCounter = 0;
+
+    // Morphing and evaluation — one array per field (structure-of-arrays) so the
+    // per-bin kernels can stream through them
+    struct BinParameterArrays
+    {
+        std::vector<float> delayL, delayR;             // Delay in samples
+        std::vector<int> delayFramesL, delayFramesR;   // Delay in whole frames, within the delay lines
+        std::vector<float> leftToLeft, leftToRight;    // Pan crossfeed gains (cos/sin of pan curve)
+        std::vector<float> rightToRight, rightToLeft;
+        std::vector<float> feedbackL, feedbackR;       // Linear gain 0-~2
+        // Dynamics (linear values)
+        std::vector<float> preGainL, preGainR;         // Linear gain (0 to 1)
+        std::vector<float> minGateL, minGateR;         // Linear threshold
+        std::vector<float> maxClipL, maxClipR;         // Linear threshold
+        // Spectral shift (normalized 0-1 curve values), and the fractional bin
+        // each source bin lands on
+        std::vector<float> shiftL, shiftR;
+        std::vector<float> multiplyL, multiplyR;
+        std::vector<float> shiftTargetL, shiftTargetR;
+        // Feedback gain actually applied this frame (zero where the delay is too short)
+        std::vector<float> feedbackGainL, feedbackGainR;
+        // Mid settings, the mean of each L/R pair above (linear values)
+        std::vector<float> delayMid, feedbackMid, preGainMid, minGateMid, maxClipMid;
+        std::vector<float> shiftTargetMid, feedbackGainMid;
+        std::vector<int> delayFramesMid;
+
+        // What the frame passes read for one side
+        struct SideView
+        {
+            const std::vector<int>& delayFrames;
+            const std::vector<float>& feedbackGain;
+            const std::vector<float>& preGain;
+            const std::vector<float>& minGate;
+            const std::vector<float>& maxClip;
+        };
+        SideView getSide(Side side) const;
+
+        void resize(int numBins);
+    };
+
+    struct SkipFlags {
+        bool delay = false;
+        bool pan = false;
+        bool feedback = false;
+        bool dynamics = false;
+        bool shift = false;
+    };
+
+    // What one stage's binParams were derived from: morph weights, the stage's
+    // curve tables (by id, per bank) and its morphed settings. A stage is only
+    // evaluated again when this changes, so a static patch derives nothing per frame.
+    enum Stage { DelayStage, PanStage, FeedbackStage, DynamicsStage, ShiftStage, kNumStages };
+    static constexpr int kMaxStageCurves = 6;
+
+    struct StageSource
+    {
+        std::array<float, 4> weights {};
+        std::array<uint64_t, 4 * kMaxStageCurves> curveIds {};
+        std::array<float, 4> settings {};
+
+        bool operator==(const StageSource& other) const
+        {
+            return weights == other.weights && curveIds == other.curveIds && settings == other.settings;
+        }
+        bool operator!=(const StageSource& other) const { return !(*this == other); }
+    };
+
+    std::array<StageSource, kNumStages> stageSources; // what binParams currently hold
+    std::array<bool, kNumStages> stageValid {};
+
+    BinParameterArrays binParams;
+
+    // Spectral shift/multiply as a gather (sparse matrix, CSR): target bin t is the
+    // sum of sources[rowStart[t] .. rowStart[t + 1]) times their weights. Rebuilt
+    // from binParams.shiftTarget only when the shift stage changes. Each row lists
+    // its sources in ascending order, so it adds up exactly like a forward scatter.
+    struct ShiftMap
+    {
+        std::vector<int> rowStart;  // numBins + 1
+        std::vector<int> rowFill;   // build scratch
+        std::vector<int> sources;   // up to two entries per source bin
+        std::vector<float> weights;
+        int activeBegin = 0;        // rows outside [activeBegin, activeEnd) are just
+        int activeEnd = 0;          // their own bin at weight 1, and are copied
+
+        void allocate(int numBins);
+        void build(const float* targets, int numBins);
+        void apply(const float* re, const float* im, float* outRe, float* outIm, int begin, int end) const;
+    };
+    std::array<ShiftMap, kNumSides> shiftMaps;
+
+    // The bins a stage's kernel runs on: every bin where its parameters differ from
+    // identity lies in [begin, end), and the rest pass through unchanged. Updated
+    // with the stage's binParams; per side, except for pan, which couples them.
+    struct BinRange
+    {
+        int begin = 0;
+        int end = 0;
+
+        bool isEmpty() const { return begin >= end; }
+        BinRange within(int first, int last) const { return { std::max(begin, first), std::min(end, last) }; }
+    };
+    std::array<BinRange, kNumSides> delayBins, dynamicsBins, feedbackBins;
+    BinRange panBins;
+    std::array<BinRange, kNumSides> storedFeedbackBins; // every pair's feedback buffers are zero outside these
+
+    void updateActiveBins(int stages);
+    int getMinFeedbackDelayFrames() const;
+
+    // Work out the source of every stage that runs this frame; returns the stages
+    // (as bits) whose binParams are stale
+    int updateStageSources(const std::array<Bank, 4>& banks, const SkipFlags& skip,
+                           const std::array<float, 4>& weights, bool shiftBeforeMult);
+
+    // Fill binParams for bins [begin, end) of the given stages from frameCurveTables
+    void evaluateBinParameters(int stages, const std::array<float, 4>& weights, int begin, int end);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectralEngine)
+};
@@ -0,0 +1,60 @@
+#include "SpectralKernels.h"
+#include "SpectralKernelsImpl.h"
+#include <juce_core/juce_core.h>
+
+namespace
+{
+constexpr SpectralKernels scalarKernels = makeKernelTable<ScalarOps>(KernelIsa::Scalar, "Scalar");
+
+const SpectralKernels* getTableFor(KernelIsa isa)
+{
+    switch (isa)
+    {
+        case KernelIsa::Scalar: return &scalarKernels;
+        case KernelIsa::SSE2:   return getSpectralKernelsSSE2();
+        case KernelIsa::AVX2:   return getSpectralKernelsAVX2();
+        case KernelIsa::AVX512: return getSpectralKernelsAVX512();
+        case KernelIsa::Auto:
+        default:                return nullptr;
+    }
+}
+
+bool cpuSupports(KernelIsa isa)
+{
+    switch (isa)
+    {
+        case KernelIsa::Scalar: return true;
+        case KernelIsa::SSE2:   return juce::SystemStats::hasSSE2();
+        case KernelIsa::AVX2:   return juce::SystemStats::hasAVX2();
+        case KernelIsa::AVX512: return juce::SystemStats::hasAVX512F();
+        case KernelIsa::Auto:
+        default:                return false;
+    }
+}
+} // namespace
+
+bool SpectralKernels::isSupported(KernelIsa isa)
+{
+    return getTableFor(isa) != nullptr && cpuSupports(isa);
+}
+
+KernelIsa SpectralKernels::getBestSupported()
+{
+    // CPU feature detection is done once per process
+    static const KernelIsa best = []
+    {
+        for (auto isa : { KernelIsa::AVX512, KernelIsa::AVX2, KernelIsa::SSE2 })
+            if (isSupported(isa))
+                return isa;
+        return KernelIsa::Scalar;
+    }();
+    return best;
+}
+
+const SpectralKernels& SpectralKernels::get(KernelIsa requested)
+{
+    if (requested != KernelIsa::Auto && isSupported(requested))
+        return *getTableFor(requested);
+
+    return *getTableFor(getBestSupported());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Structure-of-arrays per-bin kernels used by processFFTFrame.
+// Each kernel works on plain float arrays (one array per field) so the bin loop
+// can run several bins per instruction. The implementation is picked at runtime
+// from the instruction sets the CPU supports; every path can also be forced so
+// they can be compared against each other.
+
+enum class KernelIsa
+{
+    Auto = 0,   // best supported path on this CPU
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+struct SpectralKernels
+{
+    KernelIsa isa = KernelIsa::Scalar;
+    const char* name = "Scalar";
+
+    // re/im *= preGain, then gate/clip on the squared magnitude.
+    // minGate/maxClip are linear thresholds normalized so halfN is full scale:
+    // bins below minGate are zeroed, bins above maxClip are scaled down onto it.
+    void (*dynamics)(float* re, float* im,
+                     const float* preGain, const float* minGate, const float* maxClip,
+                     float halfN, int numBins) = nullptr;
+
+    // Crossfeed between the two channels, in place:
+    //   L' = L * leftToLeft + R * rightToLeft,  R' = R * rightToRight + L * leftToRight
+    void (*pan)(float* leftRe, float* leftIm, float* rightRe, float* rightIm,
+                const float* leftToLeft, const float* leftToRight,
+                const float* rightToRight, const float* rightToLeft, int numBins) = nullptr;
+
+    // fb = out * gain, with non-finite results flushed to zero
+    void (*feedbackStore)(float* fbRe, float* fbIm, const float* re, const float* im,
+                          const float* gain, int numBins) = nullptr;
+
+    // Resolve a kernel table. Auto, or an ISA this CPU/build lacks, falls back to
+    // the best supported path.
+    static const SpectralKernels& get(KernelIsa requested);
+    static bool isSupported(KernelIsa isa);
+    static KernelIsa getBestSupported();
+};
+
+// Per-ISA tables, defined in SpectralKernels<ISA>.cpp. They return nullptr when the
+// ISA was not compiled into this build (e.g. the arm64 slice of a universal binary).
+const SpectralKernels* getSpectralKernelsSSE2();
+const SpectralKernels* getSpectralKernelsAVX2();
+const SpectralKernels* getSpectralKernelsAVX512();
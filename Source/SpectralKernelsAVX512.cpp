@@ -0,0 +1,61 @@
+#include "SpectralKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+// AVX-512F implies FMA; contraction is turned off so this path rounds like the others
+#if defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+ #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target("avx512f")
+ #pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "SpectralKernelsImpl.h"
+
+namespace
+{
+
+struct Avx512Ops
+{
+    using Reg = __m512;
+    using Mask = __mmask16;
+    static constexpr int width = 16;
+
+    static Reg load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, Reg v) { _mm512_storeu_ps(p, v); }
+    static Reg set1(float v) { return _mm512_set1_ps(v); }
+    static Reg zero() { return _mm512_setzero_ps(); }
+    static Reg add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm512_div_ps(a, b); }
+    static Reg sqrt(Reg a) { return _mm512_sqrt_ps(a); }
+    static Mask lt(Reg a, Reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static Mask gt(Reg a, Reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static Mask eq(Reg a, Reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static Mask both(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+    static Reg select(Mask m, Reg a, Reg b) { return _mm512_mask_blend_ps(m, b, a); }
+};
+
+constexpr SpectralKernels avx512Kernels = makeKernelTable<Avx512Ops>(KernelIsa::AVX512, "AVX-512");
+
+} // namespace
+
+#if defined(__clang__)
+ #pragma clang attribute pop
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+const SpectralKernels* getSpectralKernelsAVX512() { return &avx512Kernels; }
+
+#else
+
+const SpectralKernels* getSpectralKernelsAVX512() { return nullptr; }
+
+#endif
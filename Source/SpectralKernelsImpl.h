@@ -0,0 +1,145 @@
+#pragma once
+
+// Kernel bodies shared by every ISA translation unit. Each SpectralKernels*.cpp
+// defines a vector-ops struct V and instantiates makeKernelTable<V>() while its
+// target ISA is enabled. Everything here lives in an anonymous namespace on
+// purpose: each translation unit gets its own internal copy compiled for its own
+// ISA, so the linker can never merge an AVX instantiation into the scalar path.
+//
+// A vector-ops struct provides:
+//   using Reg / Mask; static constexpr int width;
+//   load, store, set1, zero, add, sub, mul, div, sqrt, lt, gt, eq, both, select
+
+#include "SpectralKernels.h"
+#include <cmath>
+
+namespace
+{
+
+struct ScalarOps
+{
+    using Reg = float;
+    using Mask = bool;
+    static constexpr int width = 1;
+
+    static Reg load(const float* p) { return *p; }
+    static void store(float* p, Reg v) { *p = v; }
+    static Reg set1(float v) { return v; }
+    static Reg zero() { return 0.0f; }
+    static Reg add(Reg a, Reg b) { return a + b; }
+    static Reg sub(Reg a, Reg b) { return a - b; }
+    static Reg mul(Reg a, Reg b) { return a * b; }
+    static Reg div(Reg a, Reg b) { return a / b; }
+    static Reg sqrt(Reg a) { return std::sqrt(a); }
+    static Mask lt(Reg a, Reg b) { return a < b; }
+    static Mask gt(Reg a, Reg b) { return a > b; }
+    static Mask eq(Reg a, Reg b) { return a == b; }
+    static Mask both(Mask a, Mask b) { return a && b; }
+    static Reg select(Mask m, Reg a, Reg b) { return m ? a : b; }
+};
+
+template <typename V>
+inline void dynamicsStep(float* re, float* im, const float* preGain, const float* minGate,
+                         const float* maxClip, typename V::Reg halfN, int i)
+{
+    using Reg = typename V::Reg;
+
+    Reg gain = V::load(preGain + i);
+    Reg r = V::mul(V::load(re + i), gain);
+    Reg m = V::mul(V::load(im + i), gain);
+
+    // Compare squared magnitudes against squared absolute thresholds — the sqrt is
+    // only needed for the clip scale, never for the decision.
+    Reg mag2 = V::add(V::mul(r, r), V::mul(m, m));
+    Reg gateAbs = V::mul(V::load(minGate + i), halfN);
+    Reg clipAbs = V::mul(V::load(maxClip + i), halfN);
+
+    auto gated = V::lt(mag2, V::mul(gateAbs, gateAbs));
+    auto clipped = V::both(V::gt(mag2, V::mul(clipAbs, clipAbs)), V::gt(mag2, V::zero()));
+
+    Reg scale = V::select(clipped, V::div(clipAbs, V::sqrt(mag2)), V::set1(1.0f));
+    scale = V::select(gated, V::zero(), scale);
+
+    V::store(re + i, V::mul(r, scale));
+    V::store(im + i, V::mul(m, scale));
+}
+
+template <typename V>
+void dynamicsKernel(float* re, float* im, const float* preGain, const float* minGate,
+                    const float* maxClip, float halfN, int numBins)
+{
+    int i = 0;
+    const auto halfNV = V::set1(halfN);
+    for (; i + V::width <= numBins; i += V::width)
+        dynamicsStep<V>(re, im, preGain, minGate, maxClip, halfNV, i);
+    for (; i < numBins; ++i)
+        dynamicsStep<ScalarOps>(re, im, preGain, minGate, maxClip, halfN, i);
+}
+
+template <typename V>
+inline void panStep(float* leftRe, float* leftIm, float* rightRe, float* rightIm,
+                    const float* leftToLeft, const float* leftToRight,
+                    const float* rightToRight, const float* rightToLeft, int i)
+{
+    auto lRe = V::load(leftRe + i), lIm = V::load(leftIm + i);
+    auto rRe = V::load(rightRe + i), rIm = V::load(rightIm + i);
+    auto ll = V::load(leftToLeft + i), lr = V::load(leftToRight + i);
+    auto rr = V::load(rightToRight + i), rl = V::load(rightToLeft + i);
+
+    V::store(leftRe + i,  V::add(V::mul(lRe, ll), V::mul(rRe, rl)));
+    V::store(leftIm + i,  V::add(V::mul(lIm, ll), V::mul(rIm, rl)));
+    V::store(rightRe + i, V::add(V::mul(rRe, rr), V::mul(lRe, lr)));
+    V::store(rightIm + i, V::add(V::mul(rIm, rr), V::mul(lIm, lr)));
+}
+
+template <typename V>
+void panKernel(float* leftRe, float* leftIm, float* rightRe, float* rightIm,
+               const float* leftToLeft, const float* leftToRight,
+               const float* rightToRight, const float* rightToLeft, int numBins)
+{
+    int i = 0;
+    for (; i + V::width <= numBins; i += V::width)
+        panStep<V>(leftRe, leftIm, rightRe, rightIm, leftToLeft, leftToRight, rightToRight, rightToLeft, i);
+    for (; i < numBins; ++i)
+        panStep<ScalarOps>(leftRe, leftIm, rightRe, rightIm, leftToLeft, leftToRight, rightToRight, rightToLeft, i);
+}
+
+template <typename V>
+inline void feedbackStoreStep(float* fbRe, float* fbIm, const float* re, const float* im,
+                              const float* gain, int i)
+{
+    auto g = V::load(gain + i);
+    auto r = V::mul(V::load(re + i), g);
+    auto m = V::mul(V::load(im + i), g);
+
+    // x - x is 0 for finite x and NaN for inf/NaN, so this keeps finite lanes only
+    V::store(fbRe + i, V::select(V::eq(V::sub(r, r), V::zero()), r, V::zero()));
+    V::store(fbIm + i, V::select(V::eq(V::sub(m, m), V::zero()), m, V::zero()));
+}
+
+template <typename V>
+void feedbackStoreKernel(float* fbRe, float* fbIm, const float* re, const float* im,
+                         const float* gain, int numBins)
+{
+    int i = 0;
+    for (; i + V::width <= numBins; i += V::width)
+        feedbackStoreStep<V>(fbRe, fbIm, re, im, gain, i);
+    for (; i < numBins; ++i)
+        feedbackStoreStep<ScalarOps>(fbRe, fbIm, re, im, gain, i);
+}
+
+// constexpr so each table is constant-initialized: no ISA-specific code runs at
+// static-init time on a CPU that may not support it
+template <typename V>
+constexpr SpectralKernels makeKernelTable(KernelIsa isa, const char* name)
+{
+    SpectralKernels k;
+    k.isa = isa;
+    k.name = name;
+    k.dynamics = &dynamicsKernel<V>;
+    k.pan = &panKernel<V>;
+    k.feedbackStore = &feedbackStoreKernel<V>;
+    return k;
+}
+
+} // namespace
@@ -0,0 +1,58 @@
+#include "SpectralKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#include <emmintrin.h>
+
+#if defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target("sse2")
+#endif
+
+#include "SpectralKernelsImpl.h"
+
+namespace
+{
+
+struct Sse2Ops
+{
+    using Reg = __m128;
+    using Mask = __m128;
+    static constexpr int width = 4;
+
+    static Reg load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Reg v) { _mm_storeu_ps(p, v); }
+    static Reg set1(float v) { return _mm_set1_ps(v); }
+    static Reg zero() { return _mm_setzero_ps(); }
+    static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+    static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    static Reg div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+    static Reg sqrt(Reg a) { return _mm_sqrt_ps(a); }
+    static Mask lt(Reg a, Reg b) { return _mm_cmplt_ps(a, b); }
+    static Mask gt(Reg a, Reg b) { return _mm_cmpgt_ps(a, b); }
+    static Mask eq(Reg a, Reg b) { return _mm_cmpeq_ps(a, b); }
+    static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static Reg select(Mask m, Reg a, Reg b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+
+constexpr SpectralKernels sse2Kernels = makeKernelTable<Sse2Ops>(KernelIsa::SSE2, "SSE2");
+
+} // namespace
+
+#if defined(__clang__)
+ #pragma clang attribute pop
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+const SpectralKernels* getSpectralKernelsSSE2() { return &sse2Kernels; }
+
+#else
+
+const SpectralKernels* getSpectralKernelsSSE2() { return nullptr; }
+
+#endif
@@ -0,0 +1,76 @@
+#include "StereoFFT.h"
+#include <cstring>
+
+void StereoFFT::prepare(int fftSize)
+{
+    packedBackend = FFTBackend::createFastest(fftSize, FFTBackend::FrameKind::PackedComplex);
+    realBackend = FFTBackend::createFastest(fftSize, FFTBackend::FrameKind::RealOnly);
+    if (std::strcmp(realBackend->getName(), packedBackend->getName()) == 0)
+        realBackend.reset();
+    size = fftSize;
+    timeData.assign(static_cast<size_t>(size), Complex());
+    freqData.assign(static_cast<size_t>(size), Complex());
+}
+
+void StereoFFT::performRealOnlyForwardTransform(float* left, float* right, bool packed)
+{
+    if (!packed)
+    {
+        auto* backend = getBackend(false);
+        backend->performRealOnlyForwardTransform(left);
+        backend->performRealOnlyForwardTransform(right);
+        return;
+    }
+
+    // z = left + i * right
+    for (int n = 0; n < size; ++n)
+        timeData[n] = Complex(left[n], right[n]);
+
+    packedBackend->perform(timeData.data(), freqData.data(), false);
+
+    // With Zm = conj(Z[N - k]):  L[k] = (Z[k] + Zm) / 2,  R[k] = (Z[k] - Zm) / 2i
+    for (int k = 0; k <= size / 2; ++k)
+    {
+        Complex z = freqData[k];
+        Complex zm = std::conj(freqData[k == 0 ? 0 : size - k]);
+
+        left[2 * k]      = 0.5f * (z.real() + zm.real());
+        left[2 * k + 1]  = 0.5f * (z.imag() + zm.imag());
+        right[2 * k]     = 0.5f * (z.imag() - zm.imag());
+        right[2 * k + 1] = -0.5f * (z.real() - zm.real());
+    }
+}
+
+void StereoFFT::performRealOnlyInverseTransform(float* left, float* right, bool packed)
+{
+    if (!packed)
+    {
+        auto* backend = getBackend(false);
+        backend->performRealOnlyInverseTransform(left);
+        backend->performRealOnlyInverseTransform(right);
+        return;
+    }
+
+    // Rebuild both Hermitian spectra from bins 0..N/2 and pack them as L + i * R.
+    // The imaginary parts of DC and Nyquist only ever reach the imaginary output of
+    // a real-only inverse, so they are dropped here rather than leaking across channels.
+    const int half = size / 2;
+    for (int k = 0; k <= half; ++k)
+    {
+        bool edge = (k == 0 || k == half);
+        float lRe = left[2 * k],  lIm = edge ? 0.0f : left[2 * k + 1];
+        float rRe = right[2 * k], rIm = edge ? 0.0f : right[2 * k + 1];
+
+        freqData[k] = Complex(lRe - rIm, lIm + rRe);
+        if (!edge)
+            freqData[size - k] = Complex(lRe + rIm, rRe - lIm);
+    }
+
+    packedBackend->perform(freqData.data(), timeData.data(), true);
+
+    for (int n = 0; n < size; ++n)
+    {
+        left[n] = timeData[n].real();
+        right[n] = timeData[n].imag();
+    }
+}
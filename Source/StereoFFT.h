@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FFTBackend.h"
+#include <memory>
+#include <vector>
+
+// Real-only FFT for a stereo pair, on top of the fastest FFTBackends for the size:
+// one picked for packed frames and one for unpacked, which may differ.
+// Produces exactly the data layout of juce::dsp::FFT::performRealOnlyForwardTransform /
+// performRealOnlyInverseTransform (interleaved complex bins, buffers of 2 * size floats).
+//
+// In packed mode both channels go through a single complex transform: left is
+// the real part, right the imaginary part, and the two spectra are separated
+// with conjugate symmetry. The inverse packs the two Hermitian spectra the same
+// way, so a stereo frame costs one forward and one inverse complex FFT instead
+// of four real ones.
+//
+// The backends and the packing buffers are per instance scratch: one thread at a
+// time per StereoFFT (the engine gives every channel pair its own).
+class StereoFFT
+{
+public:
+    StereoFFT() = default;
+
+    // Any size FFTBackend supports (not only powers of two)
+    void prepare(int fftSize);
+    int getSize() const { return size; }
+    const char* getBackendName(bool packed) const
+    {
+        auto* backend = getBackend(packed);
+        return backend != nullptr ? backend->getName() : "";
+    }
+
+    // Unpacked mode runs two separate real transforms (the previous behaviour).
+    // Packed forward only writes bins 0..size/2 (floats 0..size+1) — the negative
+    // frequencies are never read by the engine or by the inverse.
+    void performRealOnlyForwardTransform(float* left, float* right, bool packed);
+    void performRealOnlyInverseTransform(float* left, float* right, bool packed);
+
+private:
+    using Complex = FFTBackend::Complex;
+
+    std::unique_ptr<FFTBackend> packedBackend;
+    std::unique_ptr<FFTBackend> realBackend; // null when the packed backend also won the real-only benchmark
+
+    FFTBackend* getBackend(bool packed) const
+    {
+        return packed || realBackend == nullptr ? packedBackend.get() : realBackend.get();
+    }
+    std::vector<Complex> timeData, freqData;
+    int size = 0;
+};
@@ -0,0 +1,237 @@
+// Half-precision delay lines against float ones, on the factory presets. Checks the
+// bound given in PluginProcessor.h and BinDelayArena.h (about -66 dB of error on
+// each delayed bin), also across a delay line handoff, and that presets without
+// feedback render within it.
+#include <juce_core/juce_core.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+constexpr double kSampleRate = 48000.0;
+constexpr int kBlockSize = 512;
+
+// Each delayed value is within 2^-11 of itself, or within 2^-25 of full scale
+// below 2^-14 of it
+constexpr float kHalfRelativeError = 1.0f / 2048.0f;
+constexpr float kHalfNormalFloor = 1.0f / 16384.0f;
+constexpr double kMaxErrorDecibels = -66.0;
+
+juce::Array<juce::File> getFactoryPresets()
+{
+    auto presets = juce::File(SPECTRASAURUS_FACTORY_PRESETS_DIR).findChildFiles(juce::File::findFiles, false, "*.spectral");
+    std::sort(presets.begin(), presets.end(),
+              [](const juce::File& a, const juce::File& b) { return a.getFileName() < b.getFileName(); });
+    return presets;
+}
+
+std::unique_ptr<SpectrasaurusAudioProcessor> loadPreset(const juce::File& preset, bool halfPrecision)
+{
+    auto processor = std::make_unique<SpectrasaurusAudioProcessor>();
+    const auto json = preset.loadFileAsString();
+    processor->setStateInformation(json.toRawUTF8(), static_cast<int>(json.getNumBytesAsUTF8()));
+    processor->setHalfPrecisionDelays(halfPrecision);
+    return processor;
+}
+
+bool hasFeedback(const std::array<Bank, 4>& banks, int numBins)
+{
+    for (const auto& bank : banks)
+        for (int bin = 0; bin < numBins; ++bin)
+            if (bank.evaluateFeedback(CurveType::FeedbackL, bin) > 0.0f
+                || bank.evaluateFeedback(CurveType::FeedbackR, bin) > 0.0f)
+                return true;
+    return false;
+}
+
+// Noise and a sine per channel for two seconds, then silence while the echoes play out
+std::vector<float> render(SpectrasaurusAudioProcessor& processor)
+{
+    constexpr int numSamples = static_cast<int>(kSampleRate) * 4;
+
+    processor.setRateAndBufferSizeDetails(kSampleRate, kBlockSize);
+    processor.prepareToPlay(kSampleRate, kBlockSize);
+
+    juce::Random random(42);
+    juce::MidiBuffer midi;
+    juce::AudioBuffer<float> buffer(2, kBlockSize);
+    std::vector<float> output;
+    output.reserve(2 * static_cast<size_t>(numSamples));
+
+    for (int start = 0; start < numSamples; start += kBlockSize)
+    {
+        for (int i = 0; i < kBlockSize; ++i)
+        {
+            const double t = (start + i) / kSampleRate;
+            const float level = (start + i) < numSamples / 2 ? 1.0f : 0.0f;
+            buffer.setSample(0, i, level * (0.2f * (random.nextFloat() - 0.5f) + 0.3f * static_cast<float>(std::sin(2.0 * juce::MathConstants<double>::pi * 440.0 * t))));
+            buffer.setSample(1, i, level * (0.2f * (random.nextFloat() - 0.5f) + 0.3f * static_cast<float>(std::sin(2.0 * juce::MathConstants<double>::pi * 1250.0 * t))));
+        }
+        processor.processBlock(buffer, midi);
+        for (int i = 0; i < kBlockSize; ++i)
+        {
+            output.push_back(buffer.getSample(0, i));
+            output.push_back(buffer.getSample(1, i));
+        }
+    }
+
+    processor.releaseResources();
+    return output;
+}
+}
+
+class DelayPrecisionTests : public juce::UnitTest
+{
+public:
+    DelayPrecisionTests() : juce::UnitTest("DelayPrecision", "Spectrasaurus") {}
+
+    void runTest() override
+    {
+        const auto presets = getFactoryPresets();
+
+        beginTest("Factory presets found");
+        expect(! presets.isEmpty(), "no presets in " SPECTRASAURUS_FACTORY_PRESETS_DIR);
+
+        beginTest("Delayed bins stay within the half-precision bound, across a handoff");
+        for (const auto& preset : presets)
+            checkDelayedBins(preset);
+
+        beginTest("Presets without feedback render within the half-precision bound");
+        for (const auto& preset : presets)
+            checkRender(preset);
+    }
+
+private:
+    // Runs spectra through float and half delay lines sized for the preset's delay
+    // curves, every bin at the longest delay its line takes. Halfway the half lines
+    // hand over to new ones (continueFrom), which must carry on exactly like lines
+    // that were never replaced.
+    void checkDelayedBins(const juce::File& preset)
+    {
+        const auto processor = loadPreset(preset, false);
+        const auto& banks = processor->banks;
+
+        SpectralEngine::Config config;
+        config.sampleRate = kSampleRate;
+        config.maxDelaySamples = static_cast<int>(kSampleRate) * 10;
+
+        auto floatLines = SpectralEngine::createDelayLines(config, banks);
+        config.halfPrecisionDelays = true;
+        auto halfLines = SpectralEngine::createDelayLines(config, banks);
+        auto handedOverLines = SpectralEngine::createDelayLines(config, banks);
+        auto takeOverLines = SpectralEngine::createDelayLines(config, banks);
+
+        const int numBins = config.fftSize / 2;
+        const float fullScale = config.fftSize / 2.0f;
+        const int longest = floatLines->getLongestDelayFrames();
+        if (longest == 0)
+            return; // nothing delayed
+
+        // Magnitudes from -120 dB to +12 dB of full scale, random phases. A short
+        // cycle of frames keeps this quick; it doesn't have to be co-prime with the delays.
+        constexpr int numSpectra = 61;
+        juce::Random random(7);
+        std::vector<std::vector<float>> spectraRe(numSpectra, std::vector<float>(static_cast<size_t>(numBins)));
+        std::vector<std::vector<float>> spectraIm = spectraRe;
+        for (int s = 0; s < numSpectra; ++s)
+        {
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                const float magnitude = fullScale * std::pow(10.0f, (random.nextFloat() * 132.0f - 120.0f) / 20.0f);
+                const float phase = random.nextFloat() * juce::MathConstants<float>::twoPi;
+                spectraRe[static_cast<size_t>(s)][static_cast<size_t>(bin)] = magnitude * std::cos(phase);
+                spectraIm[static_cast<size_t>(s)][static_cast<size_t>(bin)] = magnitude * std::sin(phase);
+            }
+        }
+
+        const int handoffFrame = longest + 1 + longest / 2;
+        const int numFrames = handoffFrame + 2 * (longest + 1);
+        double worstError = 0.0;
+        bool handoffMatches = true;
+
+        std::vector<float> floatRe(static_cast<size_t>(numBins)), floatIm(static_cast<size_t>(numBins));
+        std::vector<float> halfRe = floatRe, halfIm = floatIm, handedRe = floatRe, handedIm = floatIm;
+        std::vector<int> delayFrames(static_cast<size_t>(numBins));
+
+        for (size_t channel = 0; channel < floatLines->channels.size(); ++channel)
+        {
+            auto& floatArena = floatLines->channels[channel];
+            auto& halfArena = halfLines->channels[channel];
+            for (int bin = 0; bin < numBins; ++bin)
+                delayFrames[static_cast<size_t>(bin)] = floatArena.getMaxDelayFrames(bin);
+
+            BinDelayArena* handedArena = &handedOverLines->channels[channel];
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                if (frame == handoffFrame)
+                {
+                    takeOverLines->channels[channel].continueFrom(*handedArena);
+                    handedArena = &takeOverLines->channels[channel];
+                }
+                if (frame == handoffFrame + longest + 1)
+                    handedArena->releasePrevious();
+
+                const auto& re = spectraRe[static_cast<size_t>((frame + static_cast<int>(channel)) % numSpectra)];
+                const auto& im = spectraIm[static_cast<size_t>((frame + static_cast<int>(channel)) % numSpectra)];
+                floatRe = re; floatIm = im;
+                halfRe = re; halfIm = im;
+                handedRe = re; handedIm = im;
+
+                floatArena.process(floatRe.data(), floatIm.data(), delayFrames.data(), 0, numBins);
+                halfArena.process(halfRe.data(), halfIm.data(), delayFrames.data(), 0, numBins);
+                handedArena->process(handedRe.data(), handedIm.data(), delayFrames.data(), 0, numBins);
+
+                handoffMatches = handoffMatches && handedRe == halfRe && handedIm == halfIm;
+
+                for (size_t bin = 0; bin < static_cast<size_t>(numBins); ++bin)
+                {
+                    if (delayFrames[bin] == 0)
+                        continue;
+                    const float floorLevel = kHalfNormalFloor * fullScale;
+                    const float errorRe = std::abs(halfRe[bin] - floatRe[bin]) / std::max(std::abs(floatRe[bin]), floorLevel);
+                    const float errorIm = std::abs(halfIm[bin] - floatIm[bin]) / std::max(std::abs(floatIm[bin]), floorLevel);
+                    worstError = std::max(worstError, static_cast<double>(std::max(errorRe, errorIm)));
+                }
+            }
+        }
+
+        const auto presetName = preset.getFileNameWithoutExtension();
+        const double worstDecibels = juce::Decibels::gainToDecibels(worstError, -200.0);
+        logMessage(presetName + ": worst delayed bin error " + juce::String(worstDecibels, 1) + " dB");
+        expectLessOrEqual(worstError, static_cast<double>(kHalfRelativeError), presetName + ": delayed bin error above 2^-11");
+        expectLessOrEqual(worstDecibels, kMaxErrorDecibels, presetName + ": delayed bin error above -66 dB");
+        expect(handoffMatches, presetName + ": half-precision lines changed output across the handoff");
+    }
+
+    // With feedback, storage error goes round the loop (and through the preset's
+    // dynamics and shifts) again and again, so only the per-bin bound above applies
+    void checkRender(const juce::File& preset)
+    {
+        const auto floatProcessor = loadPreset(preset, false);
+        if (hasFeedback(floatProcessor->banks, SpectralEngine::Config().fftSize / 2))
+            return;
+
+        const auto reference = render(*floatProcessor);
+        const auto halfOutput = render(*loadPreset(preset, true));
+
+        double signalEnergy = 0.0;
+        double errorEnergy = 0.0;
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            signalEnergy += static_cast<double>(reference[i]) * reference[i];
+            errorEnergy += static_cast<double>(halfOutput[i] - reference[i]) * (halfOutput[i] - reference[i]);
+        }
+
+        const auto presetName = preset.getFileNameWithoutExtension();
+        if (errorEnergy == 0.0)
+        {
+            logMessage(presetName + ": identical");
+            return;
+        }
+
+        const double errorDecibels = 10.0 * std::log10(errorEnergy / signalEnergy);
+        logMessage(presetName + ": output error " + juce::String(errorDecibels, 1) + " dB");
+        expectLessOrEqual(errorDecibels, kMaxErrorDecibels, presetName + ": half-precision output error above -66 dB");
+    }
+};
+
+static DelayPrecisionTests delayPrecisionTests;
@@ -0,0 +1,151 @@
+// Every FFT backend against the others and a double-precision DFT, on every size
+// the plugin offers: forward and inverse complex transforms, and the real-only
+// transforms in JUCE's layout, each way and round trip.
+#include <juce_core/juce_core.h>
+#include "FFTBackend.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+using Complex = FFTBackend::Complex;
+
+// Random input makes bins of about sqrt(size); float transforms come within a few
+// 1e-7 of that, a wrong twiddle or layout is off by about 1
+constexpr double kSpectrumTolerance = 1.0e-5;
+constexpr double kRoundTripTolerance = 1.0e-5;
+constexpr int kCheckedBins = 48;
+
+// Bin k of the DFT of input, in double precision (a sample of bins keeps this quick)
+std::complex<double> directDFT(const std::vector<Complex>& input, int k)
+{
+    const int n = static_cast<int>(input.size());
+    std::complex<double> sum;
+    for (int i = 0; i < n; ++i)
+    {
+        const double angle = -2.0 * juce::MathConstants<double>::pi * static_cast<double>((static_cast<long long>(k) * i) % n) / n;
+        sum += std::complex<double>(input[static_cast<size_t>(i)]) * std::polar(1.0, angle);
+    }
+    return sum;
+}
+
+// DC, Nyquist, the last bin and a random spread in between
+std::vector<int> getCheckedBins(int size, juce::Random& random)
+{
+    std::vector<int> bins { 0, 1, size / 2, size - 1 };
+    while (static_cast<int>(bins.size()) < kCheckedBins)
+        bins.push_back(random.nextInt(size));
+    return bins;
+}
+
+struct Spectra
+{
+    juce::String backend;
+    std::vector<Complex> complex; // forward transform of the complex input
+    std::vector<float> real;      // real-only forward transform of its real part
+};
+}
+
+class FFTBackendTests : public juce::UnitTest
+{
+public:
+    FFTBackendTests() : juce::UnitTest("FFTBackend", "Spectrasaurus") {}
+
+    void runTest() override
+    {
+        for (int size : SpectrasaurusAudioProcessor::getAvailableFFTSizes())
+        {
+            beginTest("Size " + juce::String(size));
+            checkSize(size);
+        }
+    }
+
+private:
+    void checkSize(int size)
+    {
+        const auto n = static_cast<size_t>(size);
+        juce::Random random(static_cast<juce::int64>(size));
+        std::vector<Complex> input(n), realInput(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            input[i] = Complex(random.nextFloat() * 2.0f - 1.0f, random.nextFloat() * 2.0f - 1.0f);
+            realInput[i] = Complex(input[i].real(), 0.0f);
+        }
+
+        const auto bins = getCheckedBins(size, random);
+        std::vector<std::complex<double>> expected, expectedReal;
+        for (int k : bins)
+        {
+            expected.push_back(directDFT(input, k));
+            expectedReal.push_back(directDFT(realInput, k));
+        }
+
+        const double scale = std::sqrt(static_cast<double>(size));
+        std::vector<Spectra> spectra;
+        for (const auto& backendName : FFTBackend::getBackendNames())
+        {
+            auto backend = FFTBackend::create(backendName, size);
+            if (backend == nullptr)
+                continue;
+
+            const auto label = backendName + " " + juce::String(size);
+            Spectra result { backendName, std::vector<Complex>(n), std::vector<float>(2 * n) };
+
+            // Complex forward against the DFT, then back
+            backend->perform(input.data(), result.complex.data(), false);
+            double forwardError = 0.0;
+            for (size_t b = 0; b < bins.size(); ++b)
+                forwardError = std::max(forwardError, std::abs(std::complex<double>(result.complex[static_cast<size_t>(bins[b])]) - expected[b]) / scale);
+            expectLessOrEqual(forwardError, kSpectrumTolerance, label + ": complex forward against the DFT");
+
+            std::vector<Complex> roundTrip(n);
+            backend->perform(result.complex.data(), roundTrip.data(), true);
+            double roundTripError = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                roundTripError = std::max(roundTripError, static_cast<double>(std::abs(roundTrip[i] - input[i])));
+            expectLessOrEqual(roundTripError, kRoundTripTolerance, label + ": complex round trip");
+
+            // Real-only forward (bins 0..size/2) against the DFT, then back
+            for (size_t i = 0; i < n; ++i)
+                result.real[i] = input[i].real();
+            backend->performRealOnlyForwardTransform(result.real.data());
+            double realForwardError = 0.0;
+            for (size_t b = 0; b < bins.size(); ++b)
+            {
+                const auto k = static_cast<size_t>(bins[b]);
+                if (k <= n / 2)
+                    realForwardError = std::max(realForwardError, std::abs(std::complex<double>(result.real[2 * k], result.real[2 * k + 1]) - expectedReal[b]) / scale);
+            }
+            expectLessOrEqual(realForwardError, kSpectrumTolerance, label + ": real-only forward against the DFT");
+
+            std::vector<float> realRoundTrip = result.real;
+            backend->performRealOnlyInverseTransform(realRoundTrip.data());
+            double realRoundTripError = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                realRoundTripError = std::max(realRoundTripError, static_cast<double>(std::abs(realRoundTrip[i] - input[i].real())));
+            expectLessOrEqual(realRoundTripError, kRoundTripTolerance, label + ": real-only round trip");
+
+            spectra.push_back(std::move(result));
+        }
+
+        expect(!spectra.empty(), "no backend for size " + juce::String(size));
+
+        // Every pair of backends on every bin
+        for (size_t a = 0; a < spectra.size(); ++a)
+        {
+            for (size_t b = a + 1; b < spectra.size(); ++b)
+            {
+                double complexError = 0.0, realError = 0.0;
+                for (size_t i = 0; i < n; ++i)
+                    complexError = std::max(complexError, static_cast<double>(std::abs(spectra[a].complex[i] - spectra[b].complex[i])) / scale);
+                for (size_t i = 0; i < n + 2; ++i)
+                    realError = std::max(realError, static_cast<double>(std::abs(spectra[a].real[i] - spectra[b].real[i])) / scale);
+
+                const auto label = spectra[a].backend + " and " + spectra[b].backend + " " + juce::String(size);
+                expectLessOrEqual(complexError, kSpectrumTolerance, label + ": complex spectra differ");
+                expectLessOrEqual(realError, kSpectrumTolerance, label + ": real-only spectra differ");
+            }
+        }
+    }
+};
+
+static FFTBackendTests fftBackendTests;
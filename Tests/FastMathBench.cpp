@@ -0,0 +1,50 @@
+// Microbenchmark: time per call of each FastMath approximation against the
+// standard library function it replaces, over a block of random inputs.
+#include "FastMath.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr int kBlockSize = 4096;
+constexpr int kRepeats = 2000;
+
+volatile float sink = 0.0f; // keeps the timed loops from being optimised away
+
+template <typename Function>
+void bench(const char* name, const std::vector<float>& input, std::vector<float>& output, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < kRepeats; ++repeat)
+    {
+        for (int i = 0; i < kBlockSize; ++i)
+            output[(size_t) i] = function(input[(size_t) i]);
+        sink = sink + output[(size_t) (repeat % kBlockSize)];
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%-22s %6.2f ns\n", name, elapsed.count() / (kRepeats * (double) kBlockSize));
+}
+}
+
+int main()
+{
+    std::vector<float> input((size_t) kBlockSize), output((size_t) kBlockSize);
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> distribution(-3.0f, 3.0f);
+    for (auto& x : input)
+        x = distribution(generator);
+
+    bench("std::exp2", input, output, [](float x) { return std::exp2(x); });
+    bench("fastExp2", input, output, [](float x) { return fastExp2(x); });
+    bench("std::pow(10, x)", input, output, [](float x) { return std::pow(10.0f, x); });
+    bench("fastPow10", input, output, [](float x) { return fastPow10(x); });
+    bench("std::log2", input, output, [](float x) { return std::log2(std::abs(x) + 1e-3f); });
+    bench("fastLog2", input, output, [](float x) { return fastLog2(std::abs(x) + 1e-3f); });
+    bench("std::sin + std::cos", input, output, [](float x) { return std::sin(x * 100.0f) + std::cos(x * 100.0f); });
+    bench("fastSinCos", input, output, [](float x) { float s, c; fastSinCos(x * 100.0f, s, c); return s + c; });
+    bench("std::tanh", input, output, [](float x) { return std::tanh(x); });
+    bench("fastTanh", input, output, [](float x) { return fastTanh(x); });
+    return 0;
+}
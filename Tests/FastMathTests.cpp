@@ -0,0 +1,134 @@
+// Sweeps each FastMath approximation over the domain documented in FastMath.h and
+// checks its error against double-precision libm stays within the documented bound.
+#include <juce_core/juce_core.h>
+#include "FastMath.h"
+
+namespace
+{
+float floatFromBits(uint32_t bits)
+{
+    float x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// The log errors are absolute where the result is below 1 in size, else relative
+double logError(double approx, double exact)
+{
+    return std::abs(approx - exact) / std::max(1.0, std::abs(exact));
+}
+
+double relativeError(double approx, double exact)
+{
+    return std::abs(approx - exact) / std::abs(exact);
+}
+
+// Every positive normal float, at a stride that still lands in each binade many times
+constexpr uint32_t kMinNormalBits = 0x00800000;
+constexpr uint32_t kInfinityBits = 0x7f800000;
+constexpr uint32_t kNormalStride = 257;
+}
+
+class FastMathTests : public juce::UnitTest
+{
+public:
+    FastMathTests() : juce::UnitTest("FastMath", "Spectrasaurus") {}
+
+    void runTest() override
+    {
+        beginTest("fastExp2");
+        {
+            double maxError = 0.0;
+            for (double x = -126.0; x <= 127.0; x += 1e-4)
+            {
+                const float xf = static_cast<float>(x);
+                maxError = std::max(maxError, relativeError(fastExp2(xf), std::exp2(static_cast<double>(xf))));
+            }
+            expectLessOrEqual(maxError, 9.5e-8, "fastExp2 relative error");
+
+            bool wholeNumbersExact = true;
+            for (int n = -126; n <= 127; ++n)
+                wholeNumbersExact = wholeNumbersExact && fastExp2(static_cast<float>(n)) == std::ldexp(1.0f, n);
+            expect(wholeNumbersExact, "fastExp2 of a whole number is exact");
+        }
+
+        beginTest("fastLog2 and fastGainToDecibels");
+        {
+            double maxLog2Error = 0.0;
+            double maxDecibelError = 0.0;
+            for (uint32_t bits = kMinNormalBits; bits < kInfinityBits; bits += kNormalStride)
+            {
+                const float x = floatFromBits(bits);
+                maxLog2Error = std::max(maxLog2Error, logError(fastLog2(x), std::log2(static_cast<double>(x))));
+                maxDecibelError = std::max(maxDecibelError, logError(fastGainToDecibels(x), 20.0 * std::log10(static_cast<double>(x))));
+            }
+            expectLessOrEqual(maxLog2Error, 1.1e-7, "fastLog2 error");
+            expectLessOrEqual(maxDecibelError, 2.5e-7, "fastGainToDecibels error");
+            expect(fastLog2(1.0f) == 0.0f, "fastLog2(1) is exact");
+        }
+
+        beginTest("fastDecibelsToGain");
+        {
+            double maxError = 0.0;
+            for (double dB = -120.0; dB <= 120.0; dB += 1e-4)
+            {
+                const float dBf = static_cast<float>(dB);
+                maxError = std::max(maxError, relativeError(fastDecibelsToGain(dBf), std::pow(10.0, static_cast<double>(dBf) / 20.0)));
+            }
+            expectLessOrEqual(maxError, 8.0e-7, "fastDecibelsToGain relative error");
+        }
+
+        beginTest("fastPow10");
+        {
+            double maxError = 0.0;
+            for (double x = -1.0; x <= 1.0; x += 1e-5)
+            {
+                const float xf = static_cast<float>(x);
+                maxError = std::max(maxError, relativeError(fastPow10(xf), std::pow(10.0, static_cast<double>(xf))));
+            }
+            expectLessOrEqual(maxError, 2.0e-7, "fastPow10 relative error");
+            expect(fastPow10(0.0f) == 1.0f, "fastPow10(0) is exact");
+        }
+
+        beginTest("fastSinCos");
+        {
+            double maxError = 0.0;
+            for (double x = -1000.0; x <= 1000.0; x += 3e-4)
+            {
+                const float xf = static_cast<float>(x);
+                float sine, cosine;
+                fastSinCos(xf, sine, cosine);
+                maxError = std::max({ maxError,
+                                      std::abs(sine - std::sin(static_cast<double>(xf))),
+                                      std::abs(cosine - std::cos(static_cast<double>(xf))) });
+            }
+            expectLessOrEqual(maxError, 7.8e-8, "fastSinCos absolute error");
+
+            float sine, cosine;
+            fastSinCos(0.0f, sine, cosine);
+            expect(sine == 0.0f && cosine == 1.0f, "fastSinCos(0) is exact");
+        }
+
+        beginTest("fastTanh");
+        {
+            double maxError = 0.0;
+            for (double x = -20.0; x <= 20.0; x += 1e-5)
+            {
+                const float xf = static_cast<float>(x);
+                const double exact = std::tanh(static_cast<double>(xf));
+                if (exact != 0.0)
+                    maxError = std::max(maxError, relativeError(fastTanh(xf), exact));
+            }
+            // Every binade of positive normals (tanh is odd), out to where it rounds to 1
+            for (uint32_t bits = kMinNormalBits; bits < kInfinityBits; bits += kNormalStride)
+            {
+                const float x = floatFromBits(bits);
+                maxError = std::max(maxError, relativeError(fastTanh(x), std::tanh(static_cast<double>(x))));
+            }
+            expectLessOrEqual(maxError, 2.8e-7, "fastTanh relative error");
+            expect(fastTanh(0.0f) == 0.0f, "fastTanh(0) is exact");
+        }
+    }
+};
+
+static FastMathTests fastMathTests;
@@ -0,0 +1,19 @@
+// Console runner for the Spectrasaurus unit tests (ctest runs it). Exits
+// non-zero if any test fails.
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("Spectrasaurus");
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}